@@ -0,0 +1,129 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <chrono>
+#include <unordered_set>
+#include <algorithm>
+#include "../../Common/alloc_counter.h"
+#include "../../Common/graph_cache.h"
+using namespace std;
+
+ALLOC_COUNTER_INSTALL()
+
+
+// The reader every lab used before Common/dimacs.h, kept here as the baseline
+vector<unordered_set<int>> LegacyReadGraphFile(const string& filename)
+{
+    vector<unordered_set<int>> neighbour_sets;
+    ifstream fin(filename);
+    string line;
+    int vertices = 0, edges = 0;
+    while (getline(fin, line))
+    {
+        if (line[0] == 'c')
+        {
+            continue;
+        }
+
+        stringstream line_input(line);
+        char command;
+        if (line[0] == 'p')
+        {
+            string type;
+            line_input >> command >> type >> vertices >> edges;
+            neighbour_sets.resize(vertices);
+        }
+        else
+        {
+            int start, finish;
+            line_input >> command >> start >> finish;
+            neighbour_sets[start - 1].insert(finish - 1);
+            neighbour_sets[finish - 1].insert(start - 1);
+        }
+    }
+    return neighbour_sets;
+}
+
+// Heap bytes still held by the object f() returns
+template <class F>
+long long RetainedBytes(F&& f)
+{
+    long long before = alloc_counter::Take().live_bytes;
+    auto result = f();
+    return alloc_counter::Take().live_bytes - before;
+}
+
+template <class F>
+double BestOf(int repetitions, F&& f)
+{
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = chrono::steady_clock::now();
+        f();
+        double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        best = min(best, t);
+    }
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    // Usage: LoadBench [repetitions] [files...]; defaults to the Lab2 instance list
+    int repetitions = argc > 1 ? atoi(argv[1]) : 5;
+    vector<string> files;
+    for (int i = 2; i < argc; ++i) files.push_back(argv[i]);
+    if (files.empty())
+    {
+        files = {
+            "../Lab2/Graphs/brock200_1.clq",
+            "../Lab2/Graphs/brock400_1.clq",
+            "../Lab2/Graphs/C125.9.clq",
+            "../Lab2/Graphs/hamming8-4.clq",
+            "../Lab2/Graphs/keller4.clq",
+            "../Lab2/Graphs/MANN_a27.clq",
+            "../Lab2/Graphs/p_hat1000-1.clq",
+            "../Lab2/Graphs/p_hat1000-2.clq",
+            "../Lab2/Graphs/p_hat1500-1.clq",
+            "../Lab2/Graphs/p_hat500-3.clq",
+            "../Lab2/Graphs/san1000.clq",
+            "../Lab2/Graphs/sanr400_0.7.clq"
+        };
+    }
+
+    cout << "Instance; Edges; Legacy (sec); Shared loader (sec); Binary cache (sec); Speedup; Legacy (KB); Graph (KB)\n";
+    for (const string& file : files)
+    {
+        long long legacy_edges = 0, edges = 0;
+        double legacy = BestOf(repetitions, [&]
+        {
+            auto sets = LegacyReadGraphFile(file);
+            legacy_edges = 0;
+            for (auto& s : sets) legacy_edges += s.size();
+            legacy_edges /= 2;
+        });
+        double shared = BestOf(repetitions, [&]
+        {
+            Graph graph = LoadDimacs(file);
+            edges = graph.EdgeCount();
+        });
+        // The first LoadGraph writes the cache, the timed ones only map it
+        long long cached_edges = LoadGraph(file).EdgeCount();
+        double cached = BestOf(repetitions, [&]
+        {
+            Graph graph = LoadGraph(file);
+            cached_edges = graph.EdgeCount();
+        });
+        if (edges != legacy_edges || cached_edges != legacy_edges)
+            cout << "*** WARNING: edge count mismatch for " << file << " ***\n";
+
+        // Memory footprint: hash-set neighbourhoods vs the heap-loaded Graph (CSR + matrix if any)
+        long long legacy_bytes = RetainedBytes([&] { return LegacyReadGraphFile(file); });
+        long long graph_bytes = RetainedBytes([&] { return LoadDimacs(file); });
+        cout << file << "; " << edges << "; " << legacy << "; " << shared << "; " << cached << "; " << legacy / cached
+             << "; " << legacy_bytes / 1024 << "; " << graph_bytes / 1024 << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,398 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <omp.h>
+#include "../../Common/alloc_counter.h"
+#include "../../Lab1/src/coloring.h"
+#include "../../Lab2/src/grasp.h"
+#include "../../Lab3/src/tabu.h"
+#include "../../Lab4/src/bnb.h"
+using namespace std;
+
+ALLOC_COUNTER_INSTALL()
+
+
+// One line of a manifest: "<graph file> <best known value>", the path relative to the manifest
+struct Instance
+{
+    string name;
+    string path;
+    long long best_known = -1;
+};
+
+// Command line of the runner; unset numbers mean the solver's own default
+struct Options
+{
+    string solver;
+    string manifest;
+    int repetitions = 5;
+    unsigned seed = 1;
+    double time_limit = -1;
+    int iterations = -1;
+    int randomization = 2;
+    int threads = 1;
+    int portfolio = 0;
+    string label;
+    string json;
+    string csv;
+};
+
+// Outcome of one repetition
+struct RunResult
+{
+    unsigned seed = 0;
+    long long value = 0;
+    double seconds = 0;
+    bool valid = false;
+    bool interrupted = false;
+    string search;   // BnBSolver search-tree statistics as a JSON object, mcqd / bbmc only
+    string engine;   // BnBSolver engine that ran (bbmc falls back to mcqd without a bitset matrix)
+};
+
+const vector<string> kSolvers = { "sl", "dsatur", "parallel", "tabucol", "grasp", "tabu", "mcqd", "bbmc" };
+
+bool IsColoring(const string& solver)
+{
+    return solver == "sl" || solver == "dsatur" || solver == "parallel" || solver == "tabucol";
+}
+
+vector<Instance> ReadManifest(const string& manifest)
+{
+    vector<Instance> instances;
+    ifstream fin(manifest);
+    if (!fin)
+    {
+        cerr << "Cannot open manifest " << manifest << '\n';
+        return instances;
+    }
+    size_t slash = manifest.find_last_of('/');
+    string directory = slash == string::npos ? "" : manifest.substr(0, slash + 1);
+    string line;
+    while (getline(fin, line))
+    {
+        stringstream line_input(line);
+        Instance instance;
+        if (!(line_input >> instance.path) || instance.path[0] == '#')
+            continue;
+        line_input >> instance.best_known;
+        size_t name_start = instance.path.find_last_of('/');
+        instance.name = name_start == string::npos ? instance.path : instance.path.substr(name_start + 1);
+        if (instance.path[0] != '/') instance.path = directory + instance.path;
+        instances.push_back(instance);
+    }
+    return instances;
+}
+
+// Loads the graph, then times only the solve itself
+RunResult Solve(const Options& options, const string& file, unsigned seed)
+{
+    RunResult result;
+    result.seed = seed;
+    chrono::steady_clock::time_point start;
+    auto stop_clock = [&] { result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count(); };
+
+    if (IsColoring(options.solver))
+    {
+        ColoringProblem problem;
+        problem.ReadGraphFile(file);
+        problem.SetThreads(options.threads);
+        problem.Seed(seed);
+        if (options.time_limit >= 0) problem.SetTimeLimit(options.time_limit);
+        if (options.iterations > 0) problem.SetIterationLimit(options.iterations);
+        start = chrono::steady_clock::now();
+        if (options.solver == "sl") problem.Color(ColoringProblem::ColoringMethod::SmallestLast);
+        else if (options.solver == "parallel") problem.Color(ColoringProblem::ColoringMethod::Parallel);
+        else problem.Color(ColoringProblem::ColoringMethod::DSatur);
+        // TabuCol starts from the DSATUR coloring
+        if (options.solver == "tabucol")
+        {
+            problem.TabuColReduction();
+            result.interrupted = problem.WasInterrupted();
+        }
+        stop_clock();
+        result.value = problem.GetNumberOfColors();
+        result.valid = problem.Check();
+    }
+    else if (options.solver == "grasp")
+    {
+        MaxCliqueProblem problem;
+        problem.ReadGraphFile(file);
+        problem.Seed(seed);
+        omp_set_num_threads(options.threads);
+        if (options.time_limit >= 0) problem.SetTimeLimit(options.time_limit);
+        start = chrono::steady_clock::now();
+        problem.FindClique(options.randomization, options.iterations > 0 ? options.iterations : 1000);
+        stop_clock();
+        result.value = problem.GetClique().size();
+        result.valid = problem.Check();
+        result.interrupted = problem.WasInterrupted();
+    }
+    else if (options.solver == "tabu")
+    {
+        MaxCliqueTabuSearch problem;
+        problem.ReadGraphFile(file);
+        problem.SetThreads(options.threads);
+        problem.Seed(seed);
+        if (options.time_limit >= 0) problem.SetTimeLimit(options.time_limit);
+        start = chrono::steady_clock::now();
+        problem.RunSearch(options.iterations > 0 ? options.iterations : 100);
+        stop_clock();
+        result.value = problem.GetClique().size();
+        result.valid = problem.Check();
+        result.interrupted = problem.WasInterrupted();
+    }
+    else
+    {
+        BnBSolver problem;
+        problem.ReadGraphFile(file);
+        problem.ClearAll();
+        problem.SetEngine(options.solver == "bbmc" ? BnBSolver::Engine::BBMC : BnBSolver::Engine::MCQD);
+        problem.SetThreads(options.threads);
+        problem.SetPortfolio(options.portfolio);
+        problem.Seed(seed);
+        if (options.time_limit >= 0) problem.SetTimeLimit(options.time_limit);
+        if (options.iterations > 0) problem.SetIterationLimit(options.iterations);
+        start = chrono::steady_clock::now();
+        problem.RunBnB();
+        stop_clock();
+        result.value = problem.GetClique().size();
+        result.valid = problem.Check();
+        result.interrupted = problem.WasInterrupted();
+        ostringstream search;
+        problem.GetStats().WriteJson(search);
+        result.search = search.str();
+        result.engine = problem.GetEngineUsed() == BnBSolver::Engine::BBMC ? "bbmc" : "mcqd";
+    }
+    return result;
+}
+
+// Nearest-rank percentile of sorted values, p in (0, 100]
+double Percentile(const vector<double>& sorted, double p)
+{
+    size_t rank = (size_t)ceil(p / 100 * sorted.size());
+    return sorted[max<size_t>(rank, 1) - 1];
+}
+
+double Median(const vector<double>& sorted)
+{
+    size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+// Summary of the repetitions on one instance
+struct Summary
+{
+    Instance instance;
+    vector<RunResult> runs;
+    double time_min = 0, time_median = 0, time_p95 = 0;
+    long long best = 0, worst = 0;
+    double value_median = 0;
+    double gap_best = NAN, gap_median = NAN;   // percent of the best-known value, positive = worse
+    int invalid = 0;
+    int interrupted = 0;
+};
+
+Summary Summarize(const Instance& instance, const vector<RunResult>& runs, bool minimize)
+{
+    Summary summary;
+    summary.instance = instance;
+    summary.runs = runs;
+    vector<double> times, values;
+    for (const RunResult& run : runs)
+    {
+        times.push_back(run.seconds);
+        values.push_back((double)run.value);
+        summary.invalid += !run.valid;
+        summary.interrupted += run.interrupted;
+    }
+    sort(times.begin(), times.end());
+    sort(values.begin(), values.end());
+    summary.time_min = times.front();
+    summary.time_median = Median(times);
+    summary.time_p95 = Percentile(times, 95);
+    summary.best = (long long)(minimize ? values.front() : values.back());
+    summary.worst = (long long)(minimize ? values.back() : values.front());
+    summary.value_median = Median(values);
+    if (instance.best_known > 0)
+    {
+        double known = (double)instance.best_known;
+        auto gap = [&](double value) { return (minimize ? value - known : known - value) * 100 / known; };
+        summary.gap_best = gap((double)summary.best);
+        summary.gap_median = gap(summary.value_median);
+    }
+    return summary;
+}
+
+string JsonString(const string& s)
+{
+    string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + '"';
+}
+
+// NaN (no best-known value) becomes null
+string JsonNumber(double x)
+{
+    if (std::isnan(x)) return "null";
+    ostringstream out;
+    out << x;
+    return out.str();
+}
+
+void WriteJson(ostream& out, const Options& options, const vector<Summary>& summaries)
+{
+    out << "{\n";
+    out << "  \"solver\": " << JsonString(options.solver) << ",\n";
+    out << "  \"label\": " << JsonString(options.label) << ",\n";
+    out << "  \"manifest\": " << JsonString(options.manifest) << ",\n";
+    out << "  \"objective\": \"" << (IsColoring(options.solver) ? "min" : "max") << "\",\n";
+    out << "  \"repetitions\": " << options.repetitions << ",\n";
+    out << "  \"seed\": " << options.seed << ",\n";
+    out << "  \"time_limit\": " << (options.time_limit >= 0 ? JsonNumber(options.time_limit) : "null") << ",\n";
+    out << "  \"threads\": " << options.threads << ",\n";
+    out << "  \"instances\": [\n";
+    for (size_t i = 0; i < summaries.size(); ++i)
+    {
+        const Summary& s = summaries[i];
+        out << "    {\n";
+        out << "      \"instance\": " << JsonString(s.instance.name) << ",\n";
+        out << "      \"best_known\": " << (s.instance.best_known > 0 ? to_string(s.instance.best_known) : "null") << ",\n";
+        out << "      \"best\": " << s.best << ", \"median\": " << JsonNumber(s.value_median) << ", \"worst\": " << s.worst << ",\n";
+        out << "      \"gap_best_percent\": " << JsonNumber(s.gap_best) << ", \"gap_median_percent\": " << JsonNumber(s.gap_median) << ",\n";
+        out << "      \"time_min\": " << JsonNumber(s.time_min) << ", \"time_median\": " << JsonNumber(s.time_median)
+            << ", \"time_p95\": " << JsonNumber(s.time_p95) << ",\n";
+        out << "      \"invalid\": " << s.invalid << ", \"interrupted\": " << s.interrupted << ",\n";
+        out << "      \"runs\": [";
+        for (size_t r = 0; r < s.runs.size(); ++r)
+        {
+            const RunResult& run = s.runs[r];
+            out << (r ? ", " : "") << "{\"seed\": " << run.seed << ", \"value\": " << run.value << ", \"seconds\": " << JsonNumber(run.seconds)
+                << ", \"valid\": " << (run.valid ? "true" : "false") << ", \"interrupted\": " << (run.interrupted ? "true" : "false");
+            if (!run.engine.empty()) out << ", \"engine\": \"" << run.engine << "\"";
+            if (!run.search.empty()) out << ", \"search\": " << run.search;
+            out << "}";
+        }
+        out << "]\n";
+        out << "    }" << (i + 1 < summaries.size() ? "," : "") << '\n';
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+const char* kCsvHeader = "Label; Solver; Instance; Best known; Repetitions; Best; Median; Worst; Gap best (%); Gap median (%); "
+                         "Time min (sec); Time median (sec); Time p95 (sec); Invalid; Interrupted\n";
+
+void WriteCsvLine(ostream& out, const Options& options, const Summary& s)
+{
+    out << options.label << "; " << options.solver << "; " << s.instance.name << "; " << s.instance.best_known << "; " << s.runs.size()
+        << "; " << s.best << "; " << s.value_median << "; " << s.worst << "; " << s.gap_best << "; " << s.gap_median
+        << "; " << s.time_min << "; " << s.time_median << "; " << s.time_p95 << "; " << s.invalid << "; " << s.interrupted << '\n';
+}
+
+void PrintUsage()
+{
+    cerr << "Usage: SolverBench <solver> <manifest> [options]\n"
+            "  solvers: sl, dsatur, parallel, tabucol (Lab1), grasp (Lab2), tabu (Lab3), mcqd, bbmc (Lab4)\n"
+            "  --reps N           repetitions per instance (5); repetition r uses seed + r\n"
+            "  --seed S           base seed (1)\n"
+            "  --time-limit T     budget per run in seconds (solver default otherwise)\n"
+            "  --iterations I     GRASP constructions (1000), tabu starts (100), TabuCol moves, BnB nodes\n"
+            "  --randomization R  GRASP randomization (2)\n"
+            "  --threads K        worker threads (1)\n"
+            "  --portfolio P      tabu searches alongside mcqd / bbmc (0)\n"
+            "  --label L          tag of the run in the output, e.g. a commit hash\n"
+            "  --json FILE        machine-readable results; --csv FILE appends one line per instance\n";
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    if (argc < 3) return false;
+    options.solver = argv[1];
+    options.manifest = argv[2];
+    if (find(kSolvers.begin(), kSolvers.end(), options.solver) == kSolvers.end())
+    {
+        cerr << "Unknown solver " << options.solver << '\n';
+        return false;
+    }
+    for (int i = 3; i < argc; ++i)
+    {
+        string key = argv[i];
+        if (i + 1 >= argc)
+        {
+            cerr << "Missing value for " << key << '\n';
+            return false;
+        }
+        string value = argv[++i];
+        if (key == "--reps") options.repetitions = max(1, stoi(value));
+        else if (key == "--seed") options.seed = (unsigned)stoul(value);
+        else if (key == "--time-limit") options.time_limit = stod(value);
+        else if (key == "--iterations") options.iterations = stoi(value);
+        else if (key == "--randomization") options.randomization = stoi(value);
+        else if (key == "--threads") options.threads = max(1, stoi(value));
+        else if (key == "--portfolio") options.portfolio = max(0, stoi(value));
+        else if (key == "--label") options.label = value;
+        else if (key == "--json") options.json = value;
+        else if (key == "--csv") options.csv = value;
+        else
+        {
+            cerr << "Unknown option " << key << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+    vector<Instance> instances = ReadManifest(options.manifest);
+    if (instances.empty()) return 2;
+    bool minimize = IsColoring(options.solver);
+
+    vector<Summary> summaries;
+    cout << kCsvHeader;
+    for (const Instance& instance : instances)
+    {
+        vector<RunResult> runs;
+        for (int r = 0; r < options.repetitions; ++r)
+            runs.push_back(Solve(options, instance.path, options.seed + r));
+        summaries.push_back(Summarize(instance, runs, minimize));
+        WriteCsvLine(cout, options, summaries.back());
+        if (summaries.back().invalid)
+            cout << "*** WARNING: " << summaries.back().invalid << " incorrect solutions on " << instance.name << " ***\n";
+        // With LAB_PROFILE set: phases of all repetitions, on stderr to keep stdout plain CSV
+        perf_counters::Report(cerr, instance.name);
+    }
+
+    if (!options.csv.empty())
+    {
+        // Appending keeps one file as the history across commits; the header goes in once
+        bool fresh = !ifstream(options.csv).good();
+        ofstream fout(options.csv, ios::app);
+        if (fresh) fout << kCsvHeader;
+        for (const Summary& s : summaries) WriteCsvLine(fout, options, s);
+    }
+    if (!options.json.empty())
+    {
+        ofstream fout(options.json);
+        WriteJson(fout, options, summaries);
+    }
+
+    int invalid = 0;
+    for (const Summary& s : summaries) invalid += s.invalid;
+    return invalid ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+// Heap allocation counters.
+// Counting starts once exactly one translation unit of the program expands
+// ALLOC_COUNTER_INSTALL() at namespace scope; it replaces the global operator new/delete
+// with versions that keep a small size header in front of every block.
+// Without the macro all counters stay at zero and Installed() is false.
+namespace alloc_counter
+{
+    struct Counters
+    {
+        std::atomic<long long> allocations{0};
+        std::atomic<long long> deallocations{0};
+        std::atomic<long long> bytes{0};
+        std::atomic<long long> live_bytes{0};
+        std::atomic<long long> peak_bytes{0};
+        std::atomic<bool> installed{false};
+    };
+
+    inline Counters& Get()
+    {
+        static Counters counters;
+        return counters;
+    }
+
+    struct Snapshot
+    {
+        long long allocations = 0;
+        long long deallocations = 0;
+        long long bytes = 0;
+        long long live_bytes = 0;
+        long long peak_bytes = 0;
+    };
+
+    inline Snapshot Take()
+    {
+        Counters& c = Get();
+        Snapshot s;
+        s.allocations = c.allocations.load(std::memory_order_relaxed);
+        s.deallocations = c.deallocations.load(std::memory_order_relaxed);
+        s.bytes = c.bytes.load(std::memory_order_relaxed);
+        s.live_bytes = c.live_bytes.load(std::memory_order_relaxed);
+        s.peak_bytes = c.peak_bytes.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    inline bool Installed()
+    {
+        return Get().installed.load(std::memory_order_relaxed);
+    }
+
+    // Restarts the peak tracking from the current live size
+    inline void ResetPeak()
+    {
+        Counters& c = Get();
+        c.peak_bytes.store(c.live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    namespace detail
+    {
+        // Keeps max_align_t alignment for the returned pointer
+        constexpr std::size_t kHeader = alignof(std::max_align_t) > sizeof(std::size_t) ? alignof(std::max_align_t) : sizeof(std::size_t);
+
+        inline void* Allocate(std::size_t size)
+        {
+            Counters& c = Get();
+            char* p = static_cast<char*>(std::malloc(size + kHeader));
+            if (!p) throw std::bad_alloc();
+            *reinterpret_cast<std::size_t*>(p) = size;
+            c.installed.store(true, std::memory_order_relaxed);
+            c.allocations.fetch_add(1, std::memory_order_relaxed);
+            c.bytes.fetch_add((long long)size, std::memory_order_relaxed);
+            long long live = c.live_bytes.fetch_add((long long)size, std::memory_order_relaxed) + (long long)size;
+            long long peak = c.peak_bytes.load(std::memory_order_relaxed);
+            while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            {
+            }
+            return p + kHeader;
+        }
+
+        inline void Deallocate(void* ptr)
+        {
+            if (!ptr) return;
+            Counters& c = Get();
+            char* p = static_cast<char*>(ptr) - kHeader;
+            c.deallocations.fetch_add(1, std::memory_order_relaxed);
+            c.live_bytes.fetch_sub((long long)*reinterpret_cast<std::size_t*>(p), std::memory_order_relaxed);
+            std::free(p);
+        }
+    }
+}
+
+#define ALLOC_COUNTER_INSTALL()                                                                    \
+    void* operator new(std::size_t size) { return alloc_counter::detail::Allocate(size); }         \
+    void* operator new[](std::size_t size) { return alloc_counter::detail::Allocate(size); }       \
+    void operator delete(void* p) noexcept { alloc_counter::detail::Deallocate(p); }               \
+    void operator delete[](void* p) noexcept { alloc_counter::detail::Deallocate(p); }             \
+    void operator delete(void* p, std::size_t) noexcept { alloc_counter::detail::Deallocate(p); }  \
+    void operator delete[](void* p, std::size_t) noexcept { alloc_counter::detail::Deallocate(p); }
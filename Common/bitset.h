@@ -0,0 +1,211 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BITSET_HAS_AVX2 1
+#else
+#define BITSET_HAS_AVX2 0
+#endif
+
+
+// Word-aligned bitset helpers shared by the bit-parallel solvers.
+// A set over n elements is an array of (n + 63) / 64 words; bits past n are always zero.
+namespace bits
+{
+    using Word = std::uint64_t;
+
+    inline int Words(int n)
+    {
+        return (n + 63) / 64;
+    }
+
+    inline bool Test(const Word* a, int i)
+    {
+        return (a[i >> 6] >> (i & 63)) & 1;
+    }
+
+    inline void Set(Word* a, int i)
+    {
+        a[i >> 6] |= Word(1) << (i & 63);
+    }
+
+    inline void Reset(Word* a, int i)
+    {
+        a[i >> 6] &= ~(Word(1) << (i & 63));
+    }
+
+    // Sets bits [0, n) and clears the padding
+    inline void Fill(Word* a, int n)
+    {
+        int words = Words(n);
+        for (int w = 0; w < words; ++w) a[w] = ~Word(0);
+        if (n & 63) a[words - 1] = (Word(1) << (n & 63)) - 1;
+    }
+
+    inline void Clear(Word* a, int words)
+    {
+        for (int w = 0; w < words; ++w) a[w] = 0;
+    }
+
+    inline bool Any(const Word* a, int words)
+    {
+        for (int w = 0; w < words; ++w)
+            if (a[w]) return true;
+        return false;
+    }
+
+    inline int Count(const Word* a, int words)
+    {
+        int c = 0;
+        for (int w = 0; w < words; ++w) c += std::popcount(a[w]);
+        return c;
+    }
+
+    // Index of the k-th (0-based) set bit; k must be below Count(a, words)
+    inline int Select(const Word* a, int words, int k)
+    {
+        for (int w = 0; w < words; ++w)
+        {
+            int here = std::popcount(a[w]);
+            if (k >= here)
+            {
+                k -= here;
+                continue;
+            }
+            Word x = a[w];
+            for (; k > 0; --k) x &= x - 1;
+            return w * 64 + std::countr_zero(x);
+        }
+        return -1;
+    }
+
+    // Calls f(i) for every set bit in ascending order
+    template <class F>
+    inline void ForEach(const Word* a, int words, F&& f)
+    {
+        for (int w = 0; w < words; ++w)
+        {
+            Word x = a[w];
+            while (x)
+            {
+                f(w * 64 + std::countr_zero(x));
+                x &= x - 1;
+            }
+        }
+    }
+
+    // Hot kernels. Scalar versions are portable; AVX2 versions are picked at runtime
+    // on CPUs that support them (see SelectKernels).
+    enum class Kernel
+    {
+        Auto,
+        Scalar,
+        Avx2
+    };
+
+    struct Kernels
+    {
+        // |a & b|
+        int (*and_count)(const Word* a, const Word* b, int words);
+        // dst = a & b
+        void (*and_into)(Word* dst, const Word* a, const Word* b, int words);
+        // dst = a & ~b
+        void (*and_not_into)(Word* dst, const Word* a, const Word* b, int words);
+        const char* name;
+    };
+
+    namespace detail
+    {
+        inline int AndCountScalar(const Word* a, const Word* b, int words)
+        {
+            int c = 0;
+            for (int w = 0; w < words; ++w) c += std::popcount(a[w] & b[w]);
+            return c;
+        }
+
+        inline void AndIntoScalar(Word* dst, const Word* a, const Word* b, int words)
+        {
+            for (int w = 0; w < words; ++w) dst[w] = a[w] & b[w];
+        }
+
+        inline void AndNotIntoScalar(Word* dst, const Word* a, const Word* b, int words)
+        {
+            for (int w = 0; w < words; ++w) dst[w] = a[w] & ~b[w];
+        }
+
+#if BITSET_HAS_AVX2
+        // Nibble-lookup popcount (Mula et al.), summed per 64-bit lane with vpsadbw
+        __attribute__((target("avx2"))) inline int AndCountAvx2(const Word* a, const Word* b, int words)
+        {
+            const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low_mask = _mm256_set1_epi8(0x0f);
+            __m256i acc = _mm256_setzero_si256();
+            int w = 0;
+            for (; w + 4 <= words; w += 4)
+            {
+                __m256i x = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a + w)),
+                                             _mm256_loadu_si256((const __m256i*)(b + w)));
+                __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, low_mask));
+                __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), low_mask));
+                acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+            }
+            int c = int(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+                        _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+            for (; w < words; ++w) c += std::popcount(a[w] & b[w]);
+            return c;
+        }
+
+        __attribute__((target("avx2"))) inline void AndIntoAvx2(Word* dst, const Word* a, const Word* b, int words)
+        {
+            int w = 0;
+            for (; w + 4 <= words; w += 4)
+                _mm256_storeu_si256((__m256i*)(dst + w),
+                                    _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a + w)),
+                                                     _mm256_loadu_si256((const __m256i*)(b + w))));
+            for (; w < words; ++w) dst[w] = a[w] & b[w];
+        }
+
+        __attribute__((target("avx2"))) inline void AndNotIntoAvx2(Word* dst, const Word* a, const Word* b, int words)
+        {
+            int w = 0;
+            for (; w + 4 <= words; w += 4)
+                _mm256_storeu_si256((__m256i*)(dst + w),
+                                    _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(b + w)),
+                                                        _mm256_loadu_si256((const __m256i*)(a + w))));
+            for (; w < words; ++w) dst[w] = a[w] & ~b[w];
+        }
+#endif
+    }
+
+    inline bool CpuHasAvx2()
+    {
+#if BITSET_HAS_AVX2
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+
+    // Returns the requested kernel set; asking for AVX2 on a CPU without it falls back to scalar
+    inline const Kernels& SelectKernels(Kernel kernel = Kernel::Auto)
+    {
+        static const Kernels scalar = {detail::AndCountScalar, detail::AndIntoScalar, detail::AndNotIntoScalar, "scalar"};
+#if BITSET_HAS_AVX2
+        static const Kernels avx2 = {detail::AndCountAvx2, detail::AndIntoAvx2, detail::AndNotIntoAvx2, "avx2"};
+        if (kernel != Kernel::Scalar && CpuHasAvx2()) return avx2;
+#endif
+        return scalar;
+    }
+
+    inline Kernel ParseKernel(const std::string& name)
+    {
+        if (name == "scalar") return Kernel::Scalar;
+        if (name == "avx2") return Kernel::Avx2;
+        return Kernel::Auto;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "mapped_file.h"
+
+
+namespace dimacs_detail
+{
+    inline const char* SkipLine(const char* p, const char* end)
+    {
+        const void* nl = std::memchr(p, '\n', end - p);
+        return nl ? static_cast<const char*>(nl) + 1 : end;
+    }
+
+    inline const char* SkipBlanks(const char* p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        return p;
+    }
+
+    // Parses a non-negative decimal integer, returns false if there is none before the line end
+    inline bool ParseInt(const char*& p, const char* end, long long& value)
+    {
+        p = SkipBlanks(p, end);
+        if (p == end || *p < '0' || *p > '9') return false;
+        long long v = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+            v = v * 10 + (*p++ - '0');
+        value = v;
+        return true;
+    }
+}
+
+
+// Reads a DIMACS .col/.clq file ("p edge n m" header, "e u v" edge lines, "c" comments)
+inline Graph LoadDimacs(const std::string& filename)
+{
+    using namespace dimacs_detail;
+    MappedFile file(filename, true);
+    const char* p = file.Begin();
+    const char* end = file.End();
+
+    long long vertices = -1;
+    std::vector<std::pair<int, int>> edges;
+    while (p < end)
+    {
+        p = SkipBlanks(p, end);
+        if (p == end) break;
+        if (*p == '\n')
+        {
+            ++p;
+            continue;
+        }
+        char command = *p++;
+        if (command == 'e' && vertices >= 0)
+        {
+            long long u, v;
+            if (!ParseInt(p, end, u) || !ParseInt(p, end, v) || u < 1 || v < 1 || u > vertices || v > vertices)
+                throw std::runtime_error("Malformed edge line in " + filename);
+            edges.emplace_back(int(u - 1), int(v - 1));
+        }
+        else if (command == 'p')
+        {
+            // Skipping the format word ("edge", "col", ...)
+            p = SkipBlanks(p, end);
+            while (p < end && *p != ' ' && *p != '\t' && *p != '\n') ++p;
+            long long m;
+            if (!ParseInt(p, end, vertices) || !ParseInt(p, end, m))
+                throw std::runtime_error("Malformed problem line in " + filename);
+            edges.reserve((size_t)m);
+        }
+        else if (command == 'e')
+        {
+            throw std::runtime_error("Edge before the problem line in " + filename);
+        }
+        p = SkipLine(p, end);
+    }
+    if (vertices < 0) throw std::runtime_error("No problem line in " + filename);
+
+    return Graph::FromEdges(int(vertices), edges);
+}
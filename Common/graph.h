@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+// Compact immutable undirected graph shared by all labs.
+// Adjacency is stored in CSR form: neighbours of v are adj[offsets[v] .. offsets[v + 1]),
+// sorted in ascending order and free of duplicates and self-loops.
+// Graphs that are small or dense enough (see WantsMatrix) also carry a bitset adjacency
+// matrix whose rows are padded to whole 64-bit words; large sparse graphs are CSR only.
+// The arrays are either owned or point into a mapped cache file (see graph_cache.h);
+// copies share the same storage, so passing a Graph around is cheap.
+class Graph
+{
+public:
+    static constexpr int kMaxMatrixVertices = 1 << 15;
+    static constexpr int kSmallGraphVertices = 1 << 12;
+
+    int Size() const
+    {
+        return n;
+    }
+
+    long long EdgeCount() const
+    {
+        return (long long)offsets[n] / 2;
+    }
+
+    int Degree(int v) const
+    {
+        return degrees[v];
+    }
+
+    const int* NeighboursBegin(int v) const
+    {
+        return adj + offsets[v];
+    }
+
+    const int* NeighboursEnd(int v) const
+    {
+        return adj + offsets[v + 1];
+    }
+
+    bool HasMatrix() const
+    {
+        return matrix != nullptr;
+    }
+
+    // Number of 64-bit words in one matrix row
+    int RowWords() const
+    {
+        return words;
+    }
+
+    const std::uint64_t* Row(int v) const
+    {
+        return matrix + (std::size_t)v * words;
+    }
+
+    bool HasEdge(int u, int v) const
+    {
+        if (matrix) return (Row(u)[v >> 6] >> (v & 63)) & 1;
+        return std::binary_search(NeighboursBegin(u), NeighboursEnd(u), v);
+    }
+
+    static int WordsFor(int vertices)
+    {
+        return (vertices + 63) / 64;
+    }
+
+    // The matrix is always built up to kSmallGraphVertices, and above that only while it
+    // stays within a few times the CSR size, so big sparse graphs do not pay n^2 bits
+    static bool WantsMatrix(int vertices, long long adj_size)
+    {
+        if (vertices > kMaxMatrixVertices) return false;
+        if (vertices <= kSmallGraphVertices) return true;
+        long long matrix_bytes = (long long)vertices * WordsFor(vertices) * 8;
+        return matrix_bytes <= 4 * (adj_size * (long long)sizeof(int) + (vertices + 1) * 8LL);
+    }
+
+    // Bytes held by the adjacency arrays (owned or mapped)
+    long long MemoryBytes() const
+    {
+        long long bytes = (long long)n * sizeof(int) + (n + 1LL) * sizeof(std::int64_t) + offsets[n] * (long long)sizeof(int);
+        if (matrix) bytes += (long long)n * words * sizeof(std::uint64_t);
+        return bytes;
+    }
+
+    // Builds the CSR structure (and the matrix, see WantsMatrix) from 0-based edges.
+    // Duplicated edges (in either direction) and self-loops are dropped.
+    static Graph FromEdges(int vertices, const std::vector<std::pair<int, int>>& edges)
+    {
+        auto storage = std::make_shared<Storage>();
+        std::vector<std::int64_t>& offsets = storage->offsets;
+        std::vector<int>& adj = storage->adj;
+        offsets.assign(vertices + 1, 0);
+
+        // Counting the degrees including duplicates
+        for (const auto& [u, v] : edges)
+        {
+            if (u == v) continue;
+            ++offsets[u + 1];
+            ++offsets[v + 1];
+        }
+        for (int v = 0; v < vertices; ++v)
+            offsets[v + 1] += offsets[v];
+
+        // Filling the rows
+        adj.resize(offsets[vertices]);
+        std::vector<std::int64_t> fill(offsets.begin(), offsets.end() - 1);
+        for (const auto& [u, v] : edges)
+        {
+            if (u == v) continue;
+            adj[fill[u]++] = v;
+            adj[fill[v]++] = u;
+        }
+
+        // Sorting every row and squeezing the duplicates out in place
+        std::int64_t write = 0;
+        for (int v = 0; v < vertices; ++v)
+        {
+            auto first = adj.begin() + offsets[v];
+            auto last = adj.begin() + offsets[v + 1];
+            std::sort(first, last);
+            last = std::unique(first, last);
+            offsets[v] = write;
+            for (auto it = first; it != last; ++it)
+                adj[write++] = *it;
+        }
+        offsets[vertices] = write;
+        adj.resize(write);
+        adj.shrink_to_fit();
+
+        storage->degrees.resize(vertices);
+        for (int v = 0; v < vertices; ++v)
+            storage->degrees[v] = int(offsets[v + 1] - offsets[v]);
+
+        int words = WordsFor(vertices);
+        if (WantsMatrix(vertices, write))
+        {
+            storage->matrix.assign((std::size_t)vertices * words, 0);
+            for (int u = 0; u < vertices; ++u)
+            {
+                std::uint64_t* row = storage->matrix.data() + (std::size_t)u * words;
+                for (std::int64_t i = offsets[u]; i < offsets[u + 1]; ++i)
+                    row[adj[i] >> 6] |= std::uint64_t(1) << (adj[i] & 63);
+            }
+        }
+
+        Graph g;
+        g.n = vertices;
+        g.words = words;
+        g.degrees = storage->degrees.data();
+        g.offsets = offsets.data();
+        g.adj = adj.data();
+        g.matrix = storage->matrix.empty() ? nullptr : storage->matrix.data();
+        g.keep_alive = std::move(storage);
+        return g;
+    }
+
+    // Wraps arrays living in external memory (e.g. a mapped cache file) kept alive by `owner`
+    static Graph FromView(int vertices, const int* degrees, const std::int64_t* offsets, const int* adj,
+                          const std::uint64_t* matrix, std::shared_ptr<const void> owner)
+    {
+        Graph g;
+        g.n = vertices;
+        g.words = WordsFor(vertices);
+        g.degrees = degrees;
+        g.offsets = offsets;
+        g.adj = adj;
+        g.matrix = matrix;
+        g.keep_alive = std::move(owner);
+        return g;
+    }
+
+private:
+    struct Storage
+    {
+        std::vector<int> degrees;
+        std::vector<std::int64_t> offsets;
+        std::vector<int> adj;
+        std::vector<std::uint64_t> matrix;
+    };
+
+    static const std::int64_t* EmptyOffsets()
+    {
+        static const std::int64_t zero = 0;
+        return &zero;
+    }
+
+    int n = 0;
+    int words = 0;
+    const int* degrees = nullptr;
+    const std::int64_t* offsets = EmptyOffsets();
+    const int* adj = nullptr;
+    const std::uint64_t* matrix = nullptr;
+    std::shared_ptr<const void> keep_alive;
+};
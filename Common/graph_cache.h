@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+#include "dimacs.h"
+#include "graph.h"
+#include "mapped_file.h"
+
+
+// Binary graph cache (.clqb / .colb next to the DIMACS file).
+//
+// Layout, all sections aligned to 64 bytes and stored in native byte order:
+//   CacheHeader
+//   int32   degrees[n]
+//   int64   offsets[n + 1]
+//   int32   adj[2m]                      sorted CSR rows
+//   uint64  matrix[n * row_words]        only when kHasMatrix is set
+//
+// The cache remembers size, mtime and a hash of the source file. It is trusted when
+// size and mtime match; if only the mtime differs (e.g. a fresh checkout) the hash decides.
+namespace graph_cache
+{
+    constexpr std::uint32_t kVersion = 1;
+    constexpr std::uint32_t kByteOrderMark = 0x01020304;
+    constexpr std::uint32_t kHasMatrix = 1;
+
+    struct CacheHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        std::uint32_t flags;
+        std::uint32_t vertices;
+        std::uint32_t row_words;
+        std::uint64_t adj_size;
+        std::uint64_t source_size;
+        std::int64_t source_mtime;
+        std::uint64_t source_hash;
+        std::uint64_t degrees_offset;
+        std::uint64_t offsets_offset;
+        std::uint64_t adj_offset;
+        std::uint64_t matrix_offset;
+        std::uint64_t file_size;
+    };
+
+    inline std::uint64_t Align(std::uint64_t x)
+    {
+        return (x + 63) & ~std::uint64_t(63);
+    }
+
+    inline std::string CachePath(const std::string& filename)
+    {
+        return filename + "b";
+    }
+
+    // 64-bit multiplicative hash over 8-byte words, good enough to detect edited instances
+    inline std::uint64_t HashBytes(const char* data, size_t size)
+    {
+        const std::uint64_t prime = 0x100000001b3ULL;
+        std::uint64_t h = 0xcbf29ce484222325ULL ^ size;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            std::uint64_t w;
+            std::memcpy(&w, data + i, 8);
+            h = (h ^ w) * prime;
+            h ^= h >> 29;
+        }
+        for (; i < size; ++i)
+            h = (h ^ (unsigned char)data[i]) * prime;
+        return h;
+    }
+
+    inline std::int64_t ModificationTime(const std::string& filename)
+    {
+        std::error_code ec;
+        auto t = std::filesystem::last_write_time(filename, ec);
+        if (ec) return 0;
+        return (std::int64_t)t.time_since_epoch().count();
+    }
+
+    // True if every section of the header lies inside the file at a 64-byte boundary and
+    // the CSR is consistent (offsets from 0 to adj_size, non-decreasing and matching the
+    // degrees, neighbours in range), so a truncated or corrupt cache is never read past its end
+    inline bool CheckLayout(const CacheHeader& header, const char* base, std::uint64_t size)
+    {
+        std::uint64_t n = header.vertices;
+        if (n > (std::uint64_t)std::numeric_limits<int>::max()) return false;
+        auto inside = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t item)
+        {
+            return offset % 64 == 0 && offset >= sizeof(CacheHeader) && offset <= size &&
+                   count <= (size - offset) / item;
+        };
+        if (!inside(header.degrees_offset, n, sizeof(int)) ||
+            !inside(header.offsets_offset, n + 1, sizeof(std::int64_t)) ||
+            !inside(header.adj_offset, header.adj_size, sizeof(int)))
+            return false;
+        if (header.flags & kHasMatrix)
+        {
+            if (header.row_words != (n + 63) / 64 ||
+                (n > 0 && !inside(header.matrix_offset, n, sizeof(std::uint64_t) * header.row_words)))
+                return false;
+        }
+
+        const int* degrees = reinterpret_cast<const int*>(base + header.degrees_offset);
+        const std::int64_t* offsets = reinterpret_cast<const std::int64_t*>(base + header.offsets_offset);
+        const int* adj = reinterpret_cast<const int*>(base + header.adj_offset);
+        if (offsets[0] != 0 || (std::uint64_t)offsets[n] != header.adj_size) return false;
+        for (std::uint64_t v = 0; v < n; ++v)
+            if (offsets[v + 1] < offsets[v] || offsets[v + 1] - offsets[v] != degrees[v]) return false;
+        for (std::uint64_t i = 0; i < header.adj_size; ++i)
+            if (adj[i] < 0 || (std::uint64_t)adj[i] >= n) return false;
+        return true;
+    }
+
+    // Maps the cache into `graph`; returns false if it is missing, broken or stale.
+    // `source` is only needed to compare hashes when the mtime differs.
+    inline bool TryLoad(const std::string& filename, std::uint64_t source_size, std::int64_t source_mtime,
+                        const MappedFile* source, Graph& graph)
+    {
+        std::string cache = CachePath(filename);
+        std::error_code ec;
+        if (!std::filesystem::exists(cache, ec)) return false;
+
+        std::shared_ptr<MappedFile> file;
+        try
+        {
+            file = std::make_shared<MappedFile>(cache);
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+        if (file->Size() < sizeof(CacheHeader)) return false;
+
+        CacheHeader header;
+        std::memcpy(&header, file->Begin(), sizeof(header));
+        if (std::memcmp(header.magic, "CLQB", 4) != 0 || header.version != kVersion ||
+            header.byte_order != kByteOrderMark || header.file_size != file->Size() ||
+            header.source_size != source_size)
+            return false;
+        if (header.source_mtime != source_mtime)
+        {
+            if (!source || HashBytes(source->Begin(), source->Size()) != header.source_hash) return false;
+        }
+
+        const char* base = file->Begin();
+        if (!CheckLayout(header, base, file->Size())) return false;
+        const std::uint64_t* matrix = nullptr;
+        if (header.flags & kHasMatrix)
+            matrix = reinterpret_cast<const std::uint64_t*>(base + header.matrix_offset);
+        graph = Graph::FromView(int(header.vertices),
+                                reinterpret_cast<const int*>(base + header.degrees_offset),
+                                reinterpret_cast<const std::int64_t*>(base + header.offsets_offset),
+                                reinterpret_cast<const int*>(base + header.adj_offset),
+                                matrix, file);
+        return true;
+    }
+
+    // Writes the cache atomically (temporary file + rename); failures are silently ignored
+    inline void Store(const std::string& filename, const Graph& graph, std::uint64_t source_size,
+                      std::int64_t source_mtime, std::uint64_t source_hash)
+    {
+        int n = graph.Size();
+        std::uint64_t adj_size = (std::uint64_t)graph.EdgeCount() * 2;
+
+        CacheHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "CLQB", 4);
+        header.version = kVersion;
+        header.byte_order = kByteOrderMark;
+        header.flags = graph.HasMatrix() ? kHasMatrix : 0;
+        header.vertices = (std::uint32_t)n;
+        header.row_words = (std::uint32_t)graph.RowWords();
+        header.adj_size = adj_size;
+        header.source_size = source_size;
+        header.source_mtime = source_mtime;
+        header.source_hash = source_hash;
+        header.degrees_offset = Align(sizeof(CacheHeader));
+        header.offsets_offset = Align(header.degrees_offset + sizeof(int) * (std::uint64_t)n);
+        header.adj_offset = Align(header.offsets_offset + sizeof(std::int64_t) * ((std::uint64_t)n + 1));
+        header.matrix_offset = Align(header.adj_offset + sizeof(int) * adj_size);
+        header.file_size = header.matrix_offset;
+        if (graph.HasMatrix())
+            header.file_size += sizeof(std::uint64_t) * (std::uint64_t)n * graph.RowWords();
+
+        std::string cache = CachePath(filename);
+        std::string temp = cache + ".tmp" + std::to_string(std::random_device()());
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out) return;
+            std::uint64_t written = 0;
+            auto write = [&](const void* data, std::uint64_t bytes)
+            {
+                out.write(static_cast<const char*>(data), (std::streamsize)bytes);
+                written += bytes;
+            };
+            auto pad = [&](std::uint64_t target)
+            {
+                static const char zeros[64] = {};
+                while (written < target) write(zeros, std::min<std::uint64_t>(64, target - written));
+            };
+
+            write(&header, sizeof(header));
+            pad(header.degrees_offset);
+            for (int v = 0; v < n; ++v)
+            {
+                int d = graph.Degree(v);
+                write(&d, sizeof(d));
+            }
+            pad(header.offsets_offset);
+            std::int64_t offset = 0;
+            write(&offset, sizeof(offset));
+            for (int v = 0; v < n; ++v)
+            {
+                offset += graph.Degree(v);
+                write(&offset, sizeof(offset));
+            }
+            pad(header.adj_offset);
+            for (int v = 0; v < n; ++v)
+                write(graph.NeighboursBegin(v), sizeof(int) * (std::uint64_t)graph.Degree(v));
+            pad(header.matrix_offset);
+            if (graph.HasMatrix())
+                write(graph.Row(0), sizeof(std::uint64_t) * (std::uint64_t)n * graph.RowWords());
+            if (!out)
+            {
+                out.close();
+                std::error_code ec;
+                std::filesystem::remove(temp, ec);
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, cache, ec);
+        if (ec) std::filesystem::remove(temp, ec);
+    }
+}
+
+
+// Loads a DIMACS graph through the binary cache: the first load parses the text and
+// writes `<filename>b`, later loads just map that file
+inline Graph LoadGraph(const std::string& filename, bool use_cache = true)
+{
+    if (!use_cache) return LoadDimacs(filename);
+
+    std::error_code ec;
+    std::uint64_t source_size = std::filesystem::file_size(filename, ec);
+    if (ec) throw std::runtime_error("Cannot open file " + filename);
+    std::int64_t source_mtime = graph_cache::ModificationTime(filename);
+
+    Graph graph;
+    // Fast path: size and mtime match, the source is not even opened
+    if (graph_cache::TryLoad(filename, source_size, source_mtime, nullptr, graph)) return graph;
+
+    MappedFile source(filename);
+    if (graph_cache::TryLoad(filename, source_size, source_mtime, &source, graph))
+    {
+        // Same contents with a new mtime: refresh the stamp so the next load takes the fast path
+        graph_cache::Store(filename, graph, source_size, source_mtime, graph_cache::HashBytes(source.Begin(), source.Size()));
+        return graph;
+    }
+
+    graph = LoadDimacs(filename);
+    graph_cache::Store(filename, graph, source_size, source_mtime, graph_cache::HashBytes(source.Begin(), source.Size()));
+    return graph;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define COMMON_HAS_MMAP 1
+#else
+#include <fstream>
+#include <sstream>
+#define COMMON_HAS_MMAP 0
+#endif
+
+
+// Read-only view of a whole file: mmapped where possible, buffered otherwise
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filename, bool sequential = false)
+    {
+#if COMMON_HAS_MMAP
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open file " + filename);
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("Cannot stat file " + filename);
+        }
+        size = (size_t)st.st_size;
+        if (size > 0)
+        {
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED)
+            {
+                close(fd);
+                throw std::runtime_error("Cannot map file " + filename);
+            }
+            if (sequential) madvise(mapped, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+        close(fd);
+#else
+        (void)sequential;
+        std::ifstream fin(filename, std::ios::binary);
+        if (!fin) throw std::runtime_error("Cannot open file " + filename);
+        std::ostringstream ss;
+        ss << fin.rdbuf();
+        contents = ss.str();
+        data = contents.data();
+        size = contents.size();
+#endif
+    }
+
+    ~MappedFile()
+    {
+#if COMMON_HAS_MMAP
+        if (data) munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* Begin() const { return data; }
+    const char* End() const { return data + size; }
+    size_t Size() const { return size; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#if !COMMON_HAS_MMAP
+    std::string contents;
+#endif
+};
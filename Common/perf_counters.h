@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include "alloc_counter.h"
+#include "resource_usage.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define COMMON_HAS_PERF_EVENTS 1
+#else
+#define COMMON_HAS_PERF_EVENTS 0
+#endif
+
+
+// Per-phase profile of a solver run: wall time, hardware counters (cycles, instructions,
+// cache misses, branch misses; Linux perf_event_open, user space only), heap allocations
+// (alloc_counter.h, when installed) and the process peak RSS at the end of the phase.
+//
+// Off unless the environment variable LAB_PROFILE is set to anything but "" or "0";
+// then a ScopedPhase costs a single branch. When on, every scope reads the counters of
+// its thread twice (two system calls plus one getrusage), so phases entered per node or
+// per move run noticeably slower, but the kernel side of those reads is not counted.
+// Counters are per thread, so a phase run by several threads sums their work (and their
+// seconds); nested phases are inclusive. Counters the kernel or the machine does not
+// provide (no PMU in a VM, perf_event_paranoid, non-Linux) are printed as "-".
+namespace perf_counters
+{
+    enum class Phase { Load, Preprocessing, Construction, LocalSearch, Coloring, Branching };
+    constexpr int kPhases = 6;
+
+    inline const char* PhaseName(Phase phase)
+    {
+        static const char* names[kPhases] = { "load", "preprocessing", "construction", "local search", "coloring", "branching" };
+        return names[(int)phase];
+    }
+
+    enum Event { Cycles, Instructions, CacheMisses, BranchMisses };
+    constexpr int kEvents = 4;
+
+    inline bool Enabled()
+    {
+        static const bool enabled = []
+        {
+            const char* value = std::getenv("LAB_PROFILE");
+            return value && *value && std::strcmp(value, "0") != 0;
+        }();
+        return enabled;
+    }
+
+    // The hardware counters of the calling thread, opened as one group on first use
+    // so that a single read returns all of them
+    class ThreadCounters
+    {
+    public:
+        static ThreadCounters& Current()
+        {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+
+        ThreadCounters(const ThreadCounters&) = delete;
+        ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+        ~ThreadCounters()
+        {
+#if COMMON_HAS_PERF_EVENTS
+            for (int fd : fds)
+                if (fd >= 0) close(fd);
+#endif
+        }
+
+        bool Available(int event) const
+        {
+            return slot[event] >= 0;
+        }
+
+        // Current values of the available events (the others are left alone)
+        void Read(std::array<long long, kEvents>& values) const
+        {
+#if COMMON_HAS_PERF_EVENTS
+            if (leader < 0) return;
+            std::uint64_t buffer[1 + kEvents];
+            if (read(leader, buffer, sizeof(buffer)) < (ssize_t)sizeof(std::uint64_t)) return;
+            for (int e = 0; e < kEvents; ++e)
+                if (slot[e] >= 0 && (std::uint64_t)slot[e] < buffer[0])
+                    values[e] = (long long)buffer[1 + slot[e]];
+#else
+            (void)values;
+#endif
+        }
+
+    private:
+        std::array<int, kEvents> fds{ -1, -1, -1, -1 };
+        std::array<int, kEvents> slot{ -1, -1, -1, -1 };   // position in the group read, -1 if not open
+        int leader = -1;
+
+        ThreadCounters()
+        {
+#if COMMON_HAS_PERF_EVENTS
+            const std::uint64_t configs[kEvents] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+            };
+            int opened = 0;
+            for (int e = 0; e < kEvents; ++e)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[e];
+                attr.disabled = leader < 0;   // the group starts once all members are in
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+                if (fd < 0) continue;
+                fds[e] = fd;
+                slot[e] = opened++;
+                if (leader < 0) leader = fd;
+            }
+            if (leader >= 0) ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+    };
+
+    // Everything a phase measures, taken at its start and at its end
+    struct Sample
+    {
+        std::chrono::steady_clock::time_point time;
+        std::array<long long, kEvents> events{};
+        long long allocations = 0;
+        long long allocated_bytes = 0;
+
+        static Sample Take()
+        {
+            Sample sample;
+            ThreadCounters::Current().Read(sample.events);
+            alloc_counter::Snapshot heap = alloc_counter::Take();
+            sample.allocations = heap.allocations;
+            sample.allocated_bytes = heap.bytes;
+            sample.time = std::chrono::steady_clock::now();
+            return sample;
+        }
+    };
+
+    struct PhaseTotals
+    {
+        long long calls = 0;
+        double seconds = 0;
+        std::array<long long, kEvents> events{};
+        std::array<bool, kEvents> measured{};   // some thread running the phase had the counter
+        long long allocations = 0;               // process-wide, so concurrent phases overlap
+        long long allocated_bytes = 0;
+        long long peak_rss = 0;                  // process peak at the end of the phase
+    };
+
+    // Totals of all phases, collected from every thread
+    class Profiler
+    {
+    public:
+        static Profiler& Get()
+        {
+            static Profiler profiler;
+            return profiler;
+        }
+
+        void Add(Phase phase, const Sample& begin, const Sample& end)
+        {
+            long long peak = resource_usage::RusagePeakBytes();
+            const ThreadCounters& counters = ThreadCounters::Current();
+            std::lock_guard<std::mutex> lock(mutex);
+            PhaseTotals& t = totals[(int)phase];
+            ++t.calls;
+            t.seconds += std::chrono::duration<double>(end.time - begin.time).count();
+            for (int e = 0; e < kEvents; ++e)
+            {
+                if (!counters.Available(e)) continue;
+                t.events[e] += end.events[e] - begin.events[e];
+                t.measured[e] = true;
+            }
+            t.allocations += end.allocations - begin.allocations;
+            t.allocated_bytes += end.allocated_bytes - begin.allocated_bytes;
+            t.peak_rss = std::max(t.peak_rss, peak);
+        }
+
+        PhaseTotals Totals(Phase phase) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return totals[(int)phase];
+        }
+
+        void Reset()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            totals = {};
+        }
+
+        // One line per phase that ran since the last Reset(), "-" for what was not measured
+        void Print(std::ostream& out, const std::string& title) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bool heap = alloc_counter::Installed();
+            out << "Profile of " << title << ":\n"
+                << "  Phase; Calls; Time (sec); Cycles; Instructions; IPC; Cache misses; Branch misses; Allocations; Allocated (KB); Peak RSS (KB)\n";
+            for (int p = 0; p < kPhases; ++p)
+            {
+                const PhaseTotals& t = totals[p];
+                if (t.calls == 0) continue;
+                out << "  " << PhaseName((Phase)p) << "; " << t.calls << "; " << t.seconds;
+                for (int e = 0; e < kEvents; ++e)
+                {
+                    if (t.measured[e]) out << "; " << t.events[e];
+                    else out << "; -";
+                    if (e != Instructions) continue;
+                    if (t.measured[Cycles] && t.measured[Instructions] && t.events[Cycles] > 0)
+                        out << "; " << (double)t.events[Instructions] / t.events[Cycles];
+                    else
+                        out << "; -";
+                }
+                if (heap) out << "; " << t.allocations << "; " << t.allocated_bytes / 1024;
+                else out << "; -; -";
+                out << "; " << t.peak_rss / 1024 << '\n';
+            }
+        }
+
+    private:
+        mutable std::mutex mutex;
+        std::array<PhaseTotals, kPhases> totals{};
+    };
+
+    // Measures the enclosing block as one call of `phase` when profiling is on
+    class ScopedPhase
+    {
+    public:
+        explicit ScopedPhase(Phase phase) : phase(phase), active(Enabled())
+        {
+            if (active) begin = Sample::Take();
+        }
+
+        ~ScopedPhase()
+        {
+            if (active) Profiler::Get().Add(phase, begin, Sample::Take());
+        }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        Phase phase;
+        bool active;
+        Sample begin;
+    };
+
+    // Prints and clears the profile collected so far, if profiling is on
+    inline void Report(std::ostream& out, const std::string& title)
+    {
+        if (!Enabled()) return;
+        Profiler::Get().Print(out, title);
+        Profiler::Get().Reset();
+    }
+}
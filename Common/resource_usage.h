@@ -0,0 +1,60 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define COMMON_HAS_RUSAGE 1
+#else
+#define COMMON_HAS_RUSAGE 0
+#endif
+
+
+// Resident memory of the running process in bytes, 0 where it cannot be measured.
+// Linux reads VmRSS / VmHWM from /proc/self/status; other unix systems only know
+// the peak (getrusage), which then also stands in for the current value.
+namespace resource_usage
+{
+    // Value of a "Key:   1234 kB" line of /proc/self/status in bytes, -1 if missing
+    inline long long ReadProcStatus(const std::string& key)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, key.size(), key) != 0 || line.size() <= key.size() || line[key.size()] != ':')
+                continue;
+            return std::stoll(line.substr(key.size() + 1)) * 1024;
+        }
+        return -1;
+    }
+
+    // Peak from getrusage: a single system call, cheap enough to take around short phases
+    inline long long RusagePeakBytes()
+    {
+#if COMMON_HAS_RUSAGE
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+        return (long long)usage.ru_maxrss;
+#else
+        return (long long)usage.ru_maxrss * 1024;
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    inline long long PeakResidentBytes()
+    {
+        long long peak = ReadProcStatus("VmHWM");
+        return peak >= 0 ? peak : RusagePeakBytes();
+    }
+
+    inline long long CurrentResidentBytes()
+    {
+        long long current = ReadProcStatus("VmRSS");
+        return current >= 0 ? current : PeakResidentBytes();
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+
+// What a progress callback gets on every improvement
+struct SolverProgress
+{
+    double seconds = 0;        // wall-clock time since the run started
+    long long best = -1;       // value of the best solution so far (clique size or number of colors)
+    long long bound = -1;      // proven bound on the optimum, -1 while unknown
+    long long iterations = 0;  // work done so far, in the solver's iteration unit
+};
+
+
+// Anytime controls shared by the solvers of all labs:
+// a wall-clock budget on steady_clock, an iteration budget (the unit is solver specific:
+// GRASP constructions, tabu search starts, branch and bound nodes, TabuCol moves),
+// a progress callback and cooperative cancellation from any thread.
+// A solver calls StartRun() when a run begins, polls ShouldStop() at its checkpoints
+// and calls Report() whenever its best value or bound changes.
+class AnytimeSolver
+{
+public:
+    using ProgressCallback = std::function<void(const SolverProgress&)>;
+
+    // Budget of a run in seconds; infinity means none. A solver with no limit set
+    // falls back to its own default (see StartRun)
+    void SetTimeLimit(double seconds)
+    {
+        time_limit = seconds;
+        has_time_limit = true;
+    }
+
+    // Budget of a run in iterations; <= 0 means none
+    void SetIterationLimit(long long iterations)
+    {
+        iteration_limit = iterations > 0 ? iterations : std::numeric_limits<long long>::max();
+    }
+
+    // Called (serialized) with every improvement; may be invoked from worker threads
+    void SetProgressCallback(ProgressCallback callback)
+    {
+        on_progress = std::move(callback);
+    }
+
+    // Asks the current run, or the next one, to stop as soon as possible.
+    // Safe to call from any thread; stays in effect until ResetCancel()
+    void Cancel()
+    {
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    void ResetCancel()
+    {
+        cancelled.store(false, std::memory_order_relaxed);
+    }
+
+    // Also stops when *flag becomes true (one flag can stop several solvers)
+    void SetCancelFlag(const std::atomic<bool>* flag)
+    {
+        cancel_flag = flag;
+    }
+
+    // Wall-clock time since the start of the last run
+    double GetElapsedSeconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // True if the last run was cut short by a budget or by cancellation
+    bool WasInterrupted() const
+    {
+        return interrupted.load(std::memory_order_relaxed);
+    }
+
+protected:
+    // Starts the clock; default_time_limit applies when SetTimeLimit was never called
+    void StartRun(double default_time_limit = std::numeric_limits<double>::infinity())
+    {
+        start = std::chrono::steady_clock::now();
+        double seconds = has_time_limit ? time_limit : default_time_limit;
+        if (std::isfinite(seconds))
+            deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        else
+            deadline = std::chrono::steady_clock::time_point::max();
+        interrupted.store(false, std::memory_order_relaxed);
+    }
+
+    // True once the run has to end: cancelled, out of time, or `iterations` reached the budget.
+    // Reads the clock, so hot loops should call it every few hundred iterations
+    bool ShouldStop(long long iterations = 0)
+    {
+        bool stop = cancelled.load(std::memory_order_relaxed)
+            || (cancel_flag && cancel_flag->load(std::memory_order_relaxed))
+            || iterations >= iteration_limit
+            || std::chrono::steady_clock::now() >= deadline;
+        if (stop) interrupted.store(true, std::memory_order_relaxed);
+        return stop;
+    }
+
+    long long IterationLimit() const
+    {
+        return iteration_limit;
+    }
+
+    void Report(long long best, long long bound, long long iterations)
+    {
+        if (!on_progress) return;
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        on_progress(SolverProgress{GetElapsedSeconds(), best, bound, iterations});
+    }
+
+private:
+    double time_limit = std::numeric_limits<double>::infinity();
+    bool has_time_limit = false;
+    long long iteration_limit = std::numeric_limits<long long>::max();
+    ProgressCallback on_progress;
+    std::mutex progress_mutex;
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> interrupted{false};
+    const std::atomic<bool>* cancel_flag = nullptr;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+};
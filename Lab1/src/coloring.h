@@ -0,0 +1,670 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <unordered_set>
+#include <time.h>
+#include <omp.h>
+#include "../../Common/graph_cache.h"
+#include "../../Common/perf_counters.h"
+#include "../../Common/solver.h"
+using namespace std;
+
+
+//Binary max-heap over the items 0..n-1 with the position of every item kept,
+//so the key of an item can change in place (the caller sifts it afterwards)
+template <class Less>
+class IndexedMaxHeap
+{
+public:
+    IndexedMaxHeap(int n, Less less) : less(less)
+    {
+        heap.resize(n);
+        pos.resize(n);
+        for (int i = 0; i < n; ++i)
+        {
+            heap[i] = i;
+            pos[i] = i;
+        }
+        for (int i = n / 2 - 1; i >= 0; --i)
+            SiftDown(i);
+    }
+
+    bool Empty()
+    {
+        return heap.empty();
+    }
+
+    int Pop()
+    {
+        int top = heap[0];
+        Swap(0, (int)heap.size() - 1);
+        heap.pop_back();
+        pos[top] = -1;
+        if (!heap.empty())
+            SiftDown(0);
+        return top;
+    }
+
+    //Restoring the order after the key of item grew
+    void Increased(int item)
+    {
+        SiftUp(pos[item]);
+    }
+
+    //Restoring the order after the key of item dropped
+    void Decreased(int item)
+    {
+        SiftDown(pos[item]);
+    }
+
+    long long MemoryBytes()
+    {
+        return (long long)(heap.capacity() + pos.capacity()) * sizeof(int);
+    }
+
+private:
+    vector<int> heap;
+    vector<int> pos;
+    Less less;
+
+    void Swap(int i, int j)
+    {
+        swap(heap[i], heap[j]);
+        pos[heap[i]] = i;
+        pos[heap[j]] = j;
+    }
+
+    void SiftUp(int i)
+    {
+        while (i > 0 && less(heap[(i - 1) / 2], heap[i]))
+        {
+            Swap(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void SiftDown(int i)
+    {
+        int size = heap.size();
+        while (true)
+        {
+            int largest = i;
+            int l = 2 * i + 1, r = 2 * i + 2;
+            if (l < size && less(heap[largest], heap[l])) largest = l;
+            if (r < size && less(heap[largest], heap[r])) largest = r;
+            if (largest == i) return;
+            Swap(i, largest);
+            i = largest;
+        }
+    }
+};
+
+
+//Anytime controls (AnytimeSolver, Common/solver.h) apply to TabuColReduction:
+//one iteration is one tabu move, the default budget is one second
+class ColoringProblem : public AnytimeSolver
+{
+public:
+    //Smallest-last greedy (GreedyGraphColoring), DSATUR (DSaturColoring)
+    //or speculative parallel greedy (ParallelGraphColoring)
+    enum class ColoringMethod { SmallestLast, DSatur, Parallel };
+
+    int GetRandom(int a, int b)
+    {
+        uniform_int_distribution<int> uniform(a, b);
+        return uniform(generator);
+    }
+
+    //Seed of the TabuCol random choices, so that repeated runs can be reproduced
+    void Seed(unsigned seed)
+    {
+        generator.seed(seed);
+    }
+
+    void ReadGraphFile(string filename)
+    {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Load);
+        // Immutable CSR graph, repeated edges are already dropped by the shared loader
+        graph = LoadGraph(filename);
+        colors.resize(graph.Size() + 1);
+    }
+
+    void GreedyGraphColoring()
+    {
+        //Number of vertices
+        int n = graph.Size();
+
+        //Colors array
+        colors.assign(n, 0);
+
+        //Current number of used colors
+        maxcolor = 0;
+
+        //Smallest-last order and core numbers of all vertices
+        vector<int> order;
+        SmallestLastOrdering(order);
+
+        //Forbidden colors are marked with the stamp of the current vertex, so the array is never
+        //cleared (a vertex has at most degeneracy colored neighbours, so it needs at most degeneracy + 1 colors)
+        forbidden.assign(degeneracy + 2, -1);
+
+        //Greedy coloring in reverse order
+        reverse(order.begin(), order.end());
+        for (int v : order)
+        {
+            //Marking all colors used by neighbors
+            for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                if (colors[*u] != 0)
+                    forbidden[colors[*u]] = v;
+
+            //Finding the smallest available color and coloring the vertex
+            int c = 1;
+            while (forbidden[c] == v) ++c;
+            colors[v] = c;
+            if (c > maxcolor) maxcolor = c;
+        }
+    }
+
+
+    //DSATUR (Brelaz): the next vertex is the one with the most distinct colors among its neighbours
+    //(saturation), ties go to the largest degree in the uncolored subgraph, then to the lowest index.
+    //Vertices wait in an indexed max-heap on that key, which changes only along the edges of the
+    //vertex just colored, so the whole run is O((n + m) log n).
+    void DSaturColoring()
+    {
+        int n = graph.Size();
+        colors.assign(n, 0);
+        maxcolor = 0;
+
+        //Colors seen around each vertex as a bitmask: vertex v ends up with a color <= degree(v) + 1,
+        //so only those bits matter for its choice; higher neighbour colors (possible next to hubs)
+        //only add to the saturation and are kept as (vertex, color) pairs in a hash set
+        maskOffset.assign(n + 1, 0);
+        for (int v = 0; v < n; ++v)
+            maskOffset[v + 1] = maskOffset[v] + Graph::WordsFor(graph.Degree(v) + 2);
+        neighbourColors.assign(maskOffset[n], 0);
+        unordered_set<long long> highColors;
+
+        vector<int> saturation(n, 0);
+        vector<int> uncoloredDegree(n);
+        for (int v = 0; v < n; ++v)
+            uncoloredDegree[v] = graph.Degree(v);
+
+        auto less = [&](int a, int b)
+        {
+            if (saturation[a] != saturation[b]) return saturation[a] < saturation[b];
+            if (uncoloredDegree[a] != uncoloredDegree[b]) return uncoloredDegree[a] < uncoloredDegree[b];
+            return a > b;
+        };
+        IndexedMaxHeap<decltype(less)> queue(n, less);
+
+        while (!queue.Empty())
+        {
+            int v = queue.Pop();
+
+            //The smallest color missing from the mask (color 0 does not exist)
+            uint64_t* mask = neighbourColors.data() + maskOffset[v];
+            int words = int(maskOffset[v + 1] - maskOffset[v]);
+            int c = 0;
+            for (int w = 0; w < words; ++w)
+            {
+                uint64_t free = ~mask[w];
+                if (w == 0) free &= ~uint64_t(1);
+                if (free)
+                {
+                    c = w * 64 + countr_zero(free);
+                    break;
+                }
+            }
+            colors[v] = c;
+            if (c > maxcolor) maxcolor = c;
+
+            //Updating the keys of the uncolored neighbours
+            for (const int* it = graph.NeighboursBegin(v); it != graph.NeighboursEnd(v); ++it)
+            {
+                int u = *it;
+                if (colors[u] != 0) continue;
+                bool added;
+                if (c < (maskOffset[u + 1] - maskOffset[u]) * 64)
+                {
+                    uint64_t& word = neighbourColors[maskOffset[u] + c / 64];
+                    uint64_t bit = uint64_t(1) << (c % 64);
+                    added = !(word & bit);
+                    word |= bit;
+                }
+                else
+                {
+                    added = highColors.insert((long long)u << 32 | c).second;
+                }
+                --uncoloredDegree[u];
+                if (added)
+                {
+                    ++saturation[u];
+                    queue.Increased(u);
+                }
+                else
+                {
+                    queue.Decreased(u);
+                }
+            }
+        }
+        dsaturWorkBytes = queue.MemoryBytes() + (long long)(saturation.capacity() + uncoloredDegree.capacity()) * sizeof(int);
+    }
+
+    //Speculative parallel greedy coloring (Gebremedhin & Manne) with OpenMP.
+    //Every round colors the work list in parallel, each thread taking the smallest color free among
+    //the neighbours as it sees them at that moment, so two adjacent vertices colored at the same
+    //time may clash. A second parallel pass finds the clashes (of two equal neighbours the larger
+    //index loses) and the losers form the next work list, until a round produces none.
+    //The first round follows the smallest-last coloring order, so one thread gives the same
+    //coloring as GreedyGraphColoring.
+    void ParallelGraphColoring()
+    {
+        int n = graph.Size();
+        colors.assign(n, 0);
+        maxcolor = 0;
+        rounds = 0;
+        recolored = 0;
+
+        vector<int> work;
+        SmallestLastOrdering(work);
+        reverse(work.begin(), work.end());
+        int max_degree = 0;
+        for (int i = 0; i < n; ++i)
+            max_degree = max(max_degree, graph.Degree(i));
+
+        vector<int> conflicts;
+        #pragma omp parallel num_threads(threads)
+        {
+            //Forbidden colors are marked with the stamp of the current vertex, one array per thread
+            vector<int> forbiddenLocal(max_degree + 2, -1);
+            vector<int> conflictsLocal;
+            while (true)
+            {
+                //Speculative coloring, neighbour colors may change under our feet.
+                //Small chunks handed out in order keep the threads close to the front of the order,
+                //so few vertices are in flight at a time and the coloring stays near the sequential one
+                #pragma omp for schedule(dynamic, 64)
+                for (int i = 0; i < (int)work.size(); ++i)
+                {
+                    int v = work[i];
+                    for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                    {
+                        int c = atomic_ref<int>(colors[*u]).load(memory_order_relaxed);
+                        if (c != 0)
+                            forbiddenLocal[c] = v;
+                    }
+                    int c = 1;
+                    while (forbiddenLocal[c] == v) ++c;
+                    atomic_ref<int>(colors[v]).store(c, memory_order_relaxed);
+                }
+
+                //Conflict detection, colors are stable until the next round
+                conflictsLocal.clear();
+                #pragma omp for schedule(static) nowait
+                for (int i = 0; i < (int)work.size(); ++i)
+                {
+                    int v = work[i];
+                    for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                        if (*u < v && colors[*u] == colors[v])
+                        {
+                            conflictsLocal.push_back(v);
+                            break;
+                        }
+                }
+                #pragma omp critical
+                conflicts.insert(conflicts.end(), conflictsLocal.begin(), conflictsLocal.end());
+                #pragma omp barrier
+
+                #pragma omp single
+                {
+                    ++rounds;
+                    recolored += conflicts.size();
+                    work.swap(conflicts);
+                    conflicts.clear();
+                    sort(work.begin(), work.end());
+                }
+                if (work.empty()) break;
+            }
+        }
+
+        for (int v = 0; v < n; ++v)
+            maxcolor = max(maxcolor, colors[v]);
+    }
+
+    //Number of threads for ParallelGraphColoring
+    void SetThreads(int t)
+    {
+        threads = max(1, t);
+    }
+
+    //Rounds of the last ParallelGraphColoring and vertices recolored after the first one
+    int GetRounds()
+    {
+        return rounds;
+    }
+
+    long long GetRecolored()
+    {
+        return recolored;
+    }
+
+    //TabuCol (Hertz & de Werra) color reduction on top of the current coloring with k colors:
+    //the vertices of color k are moved to their least conflicting color in 1..k-1 and tabu search
+    //minimizes the number of conflicting edges; each conflict-free result replaces the coloring and
+    //the next color is removed, until a run does not finish within the budget or is cancelled.
+    //There is no lower bound to stop at, so the whole budget is always used (the run one color
+    //below the best reachable coloring only ends with it), except when 2 colors are reached:
+    //a single color needs an edgeless graph, which every greedy coloring already gives 1 color.
+    //gamma[v * k + c] counts the neighbours of v with color c, so a move is evaluated in O(1)
+    //and applied in O(deg) (only the neighbours of the moved vertex change).
+    void TabuColReduction(double seconds)
+    {
+        SetTimeLimit(seconds);
+        TabuColReduction();
+    }
+
+    void TabuColReduction()
+    {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::LocalSearch);
+        StartRun(1.0);
+        int n = graph.Size();
+        tabuIterations = 0;
+
+        while (maxcolor > 2)
+        {
+            //Colors are 0-based inside the search
+            int k = maxcolor - 1;
+            vector<int> col(n);
+            for (int v = 0; v < n; ++v)
+                col[v] = colors[v] - 1;
+
+            vector<int> gamma((size_t)n * k, 0);
+            for (int v = 0; v < n; ++v)
+                if (col[v] < k)
+                    for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                        ++gamma[(size_t)*u * k + col[v]];
+            for (int v = 0; v < n; ++v)
+            {
+                if (col[v] < k) continue;
+                int c = 0;
+                for (int d = 1; d < k; ++d)
+                    if (gamma[(size_t)v * k + d] < gamma[(size_t)v * k + c])
+                        c = d;
+                col[v] = c;
+                for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                    ++gamma[(size_t)*u * k + c];
+            }
+
+            //Vertices with at least one neighbour of the same color, kept in an indexed list
+            vector<int> conflicting;
+            vector<int> position(n, -1);
+            long long f = 0;
+            auto update = [&](int v)
+            {
+                bool now = gamma[(size_t)v * k + col[v]] > 0;
+                if (now && position[v] == -1)
+                {
+                    position[v] = conflicting.size();
+                    conflicting.push_back(v);
+                }
+                else if (!now && position[v] != -1)
+                {
+                    int last = conflicting.back();
+                    conflicting[position[v]] = last;
+                    position[last] = position[v];
+                    conflicting.pop_back();
+                    position[v] = -1;
+                }
+            };
+            for (int v = 0; v < n; ++v)
+            {
+                f += gamma[(size_t)v * k + col[v]];
+                update(v);
+            }
+            f /= 2;
+
+            //tabu[v * k + c]: iteration until which moving v back to c is forbidden
+            vector<long long> tabu((size_t)n * k, 0);
+            long long bestF = f;
+            long long iteration = 0;
+            bool timeout = false;
+            while (f > 0)
+            {
+                if ((iteration & 255) == 0 && ShouldStop(tabuIterations + iteration))
+                {
+                    timeout = true;
+                    break;
+                }
+                ++iteration;
+
+                //Best non-tabu move (tabu moves are allowed if they beat the best conflict count),
+                //ties are broken uniformly
+                int moveVertex = -1, moveColor = -1;
+                long long moveDelta = 0;
+                int ties = 0;
+                for (int v : conflicting)
+                {
+                    const int* g = gamma.data() + (size_t)v * k;
+                    for (int c = 0; c < k; ++c)
+                    {
+                        if (c == col[v]) continue;
+                        long long delta = g[c] - g[col[v]];
+                        if (tabu[(size_t)v * k + c] > iteration && f + delta >= bestF) continue;
+                        if (moveVertex == -1 || delta < moveDelta)
+                        {
+                            moveVertex = v;
+                            moveColor = c;
+                            moveDelta = delta;
+                            ties = 1;
+                        }
+                        else if (delta == moveDelta && GetRandom(0, ties++) == 0)
+                        {
+                            moveVertex = v;
+                            moveColor = c;
+                        }
+                    }
+                }
+                //Everything is tabu: a random move of a conflicting vertex
+                if (moveVertex == -1)
+                {
+                    moveVertex = conflicting[GetRandom(0, conflicting.size() - 1)];
+                    moveColor = (col[moveVertex] + GetRandom(1, k - 1)) % k;
+                    moveDelta = gamma[(size_t)moveVertex * k + moveColor] - gamma[(size_t)moveVertex * k + col[moveVertex]];
+                }
+
+                int v = moveVertex;
+                int old = col[v];
+                col[v] = moveColor;
+                for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                {
+                    --gamma[(size_t)*u * k + old];
+                    ++gamma[(size_t)*u * k + moveColor];
+                    update(*u);
+                }
+                update(v);
+                f += moveDelta;
+                bestF = min(bestF, f);
+
+                //Dynamic tenure: L in [0, 9] plus 0.6 per conflicting vertex
+                tabu[(size_t)v * k + old] = iteration + GetRandom(0, 9) + (long long)(0.6 * conflicting.size());
+            }
+            tabuIterations += iteration;
+            if (timeout) break;
+
+            //Conflict-free with k colors
+            maxcolor = 0;
+            for (int v = 0; v < n; ++v)
+            {
+                colors[v] = col[v] + 1;
+                maxcolor = max(maxcolor, colors[v]);
+            }
+            Report(maxcolor, -1, tabuIterations);
+        }
+    }
+
+    //Tabu search iterations of the last TabuColReduction
+    long long GetTabuIterations()
+    {
+        return tabuIterations;
+    }
+
+    void Color(ColoringMethod method)
+    {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Coloring);
+        if (method == ColoringMethod::DSatur)
+            DSaturColoring();
+        else if (method == ColoringMethod::Parallel)
+            ParallelGraphColoring();
+        else
+            GreedyGraphColoring();
+    }
+
+    bool Check()
+    {
+        for (int i = 0; i < graph.Size(); ++i)
+        {
+            if (colors[i] == 0)
+            {
+                cout << "Vertex " << i + 1 << " is not colored\n";
+                return false;
+            }
+            for (const int* it = graph.NeighboursBegin(i); it != graph.NeighboursEnd(i); ++it)
+            {
+                int neighbour = *it;
+                if (colors[neighbour] == colors[i])
+                {
+                    cout << "Neighbour vertices " << i + 1 << ", " << neighbour + 1 <<  " have the same color\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    //Largest k such that the graph has a non-empty k-core (known after GreedyGraphColoring).
+    //Smallest-last coloring never uses more than degeneracy + 1 colors.
+    int GetDegeneracy()
+    {
+        return degeneracy;
+    }
+
+    //Core number of every vertex: the largest k such that it belongs to the k-core
+    const vector<int>& GetCoreNumbers()
+    {
+        return core;
+    }
+
+    int GetNumberOfColors()
+    {
+        return maxcolor;
+    }
+
+    const vector<int>& GetColors()
+    {
+        return colors;
+    }
+
+    //Bytes used by the graph and the coloring buffers
+    long long GetMemoryFootprint()
+    {
+        return graph.MemoryBytes() + (long long)(colors.capacity() + forbidden.capacity()) * sizeof(int)
+            + (long long)(neighbourColors.capacity() + maskOffset.capacity()) * sizeof(uint64_t) + dsaturWorkBytes;
+    }
+
+private:
+    vector<int> colors;
+    int maxcolor = 1;
+    Graph graph;
+    vector<int> forbidden;
+    vector<int> core;
+    int degeneracy = 0;
+    vector<uint64_t> neighbourColors;
+    vector<int64_t> maskOffset;
+    long long dsaturWorkBytes = 0;
+    int threads = omp_get_max_threads();
+    int rounds = 0;
+    long long recolored = 0;
+    long long tabuIterations = 0;
+    mt19937 generator;
+
+    //Smallest-last (degeneracy) order with a bucket queue (Matula & Beck), O(n + m):
+    //buckets[d] is a doubly linked list of the remaining vertices with degree d in the remaining graph.
+    //Removing a vertex moves each remaining neighbour one bucket down, so the smallest
+    //non-empty bucket decreases by at most one per step and the pointer scan is amortized O(n).
+    //The order is returned in deletion order (the last deleted vertex is colored first).
+    void SmallestLastOrdering(vector<int>& order)
+    {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Preprocessing);
+        int n = graph.Size();
+        order.clear();
+        order.reserve(n);
+        core.assign(n, 0);
+        degeneracy = 0;
+
+        int max_degree = 0;
+        vector<int> deg(n);
+        for (int i = 0; i < n; ++i)
+        {
+            deg[i] = graph.Degree(i);
+            max_degree = max(max_degree, deg[i]);
+        }
+
+        //Buckets are FIFO lists: vertices start in index order and moved vertices go to the tail
+        vector<int> head(max_degree + 1, -1), tail(max_degree + 1, -1), next(n, -1), prev(n, -1);
+        auto push = [&](int v)
+        {
+            int d = deg[v];
+            next[v] = -1;
+            prev[v] = tail[d];
+            if (tail[d] != -1) next[tail[d]] = v;
+            else head[d] = v;
+            tail[d] = v;
+        };
+        auto unlink = [&](int v)
+        {
+            if (prev[v] != -1) next[prev[v]] = next[v];
+            else head[deg[v]] = next[v];
+            if (next[v] != -1) prev[next[v]] = prev[v];
+            else tail[deg[v]] = prev[v];
+        };
+        for (int i = 0; i < n; ++i)
+            push(i);
+
+        //"Deleting" vertices with bool markers, the graph itself is never copied
+        vector<bool> removed(n, false);
+        int d = 0;
+        for (int step = 0; step < n; ++step)
+        {
+            //Finding the vertex with the smallest degree
+            while (head[d] == -1) ++d;
+            int v = head[d];
+            unlink(v);
+            removed[v] = true;
+            order.push_back(v);
+
+            //The core number is the largest degree seen at deletion so far
+            degeneracy = max(degeneracy, d);
+            core[v] = degeneracy;
+
+            //Removing vertex from neighbors
+            for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                if (!removed[*u])
+                {
+                    unlink(*u);
+                    --deg[*u];
+                    push(*u);
+                }
+            if (d > 0) --d;
+        }
+    }
+};
@@ -1,160 +1,22 @@
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <vector>
-#include <sstream>
-#include <random>
-#include <algorithm>
-#include <unordered_set>
-#include <time.h>
-using namespace std;
+#include "../../Common/alloc_counter.h"
+#include "coloring.h"
 
+//Counting heap allocations for the per-phase profile (LAB_PROFILE=1)
+ALLOC_COUNTER_INSTALL()
 
-class ColoringProblem
-{
-public:
-    int GetRandom(int a, int b)
-    {
-        static mt19937 generator;
-        uniform_int_distribution<int> uniform(a, b);
-        return uniform(generator);
-    }
-
-    void ReadGraphFile(string filename)
-    {
-        ifstream fin(filename);
-        string line;
-        int vertices = 0, edges = 0;
-        while (getline(fin, line))
-        {
-            if (line[0] == 'c')
-            {
-                continue;
-            }
-
-            stringstream line_input(line);
-            char command;
-            if (line[0] == 'p')
-            {
-                string type;
-                line_input >> command >> type >> vertices >> edges;
-                neighbour_sets.resize(vertices);
-                colors.resize(vertices + 1);
-            }
-            else
-            {
-                int start, finish;
-                line_input >> command >> start >> finish;
-                // Edges in DIMACS file can be repeated, but it is not a problem for our sets
-                neighbour_sets[start - 1].insert(finish - 1);
-                neighbour_sets[finish - 1].insert(start - 1);
-            }
-        }
-    }
-
-    void GreedyGraphColoring()
-    {
-        //Number of vertices
-        int n = neighbour_sets.size();
-
-        //Colors array
-        colors.assign(n, 0);
-
-        //Current number of used colors
-        maxcolor = 0;
-
-        //Computing the degree of each vertex
-        vector<int> deg(n);
-        for (int i = 0; i < n; ++i)
-            deg[i] = neighbour_sets[i].size();
-
-        //Deletion order (reserving memory for n ints)
-        vector<int> order;
-        order.reserve(n);
-
-        //Copying the graph for "deleting" vertices with bool markers
-        vector<unordered_set<int>> adj_copy = neighbour_sets;
-        vector<bool> removed(n, false);
-
-        //n times for every vertex
-        for (int step = 0; step < n; ++step)
-        {
-            //Finding the vertex with the smallest degree
-            int v = -1;
-            for (int i = 0; i < n; ++i)
-            {
-                if (!removed[i] && (v == -1 || adj_copy[i].size() < adj_copy[v].size()))
-                    v = i;
-            }
-
-            //Removing vertex
-            removed[v] = true;
-            order.push_back(v);
-
-            //Removing vertex from neighbors
-            for (int u : adj_copy[v])
-                adj_copy[u].erase(v);
-            adj_copy[v].clear();
-        }
-
-        //Greedy coloring in reverse order
-        reverse(order.begin(), order.end());
-        for (int v : order)
-        {
-            //Collecting all colors used by neighbors
-            unordered_set<int> used_colors;
-            for (int u : neighbour_sets[v])
-                if (colors[u] != 0)
-                    used_colors.insert(colors[u]);
-
-            //Finding the smallest available color and coloring the vertex
-            int c = 1;
-            while (used_colors.count(c)) ++c;
-            colors[v] = c;
-            if (c > maxcolor) maxcolor = c;
-        }
-    }
-
-
-    bool Check()
-    {
-        for (size_t i = 0; i < neighbour_sets.size(); ++i)
-        {
-            if (colors[i] == 0)
-            {
-                cout << "Vertex " << i + 1 << " is not colored\n";
-                return false;
-            }
-            for (int neighbour : neighbour_sets[i])
-            {
-                if (colors[neighbour] == colors[i])
-                {
-                    cout << "Neighbour vertices " << i + 1 << ", " << neighbour + 1 <<  " have the same color\n";
-                    return false;
-                }
-            }
-        }
-        return true;
-    }
-
-    int GetNumberOfColors()
-    {
-        return maxcolor;
-    }
-
-    const vector<int>& GetColors()
-    {
-        return colors;
-    }
 
-private:
-    vector<int> colors;
-    int maxcolor = 1;
-    vector<unordered_set<int>> neighbour_sets;
-};
-
-int main()
+int main(int argc, char* argv[])
 {
+    //Optional arguments: coloring method (sl, dsatur, parallel), all of them by default,
+    //and the number of threads for the parallel one
+    vector<ColoringProblem::ColoringMethod> methods = { ColoringProblem::ColoringMethod::SmallestLast, ColoringProblem::ColoringMethod::DSatur, ColoringProblem::ColoringMethod::Parallel };
+    if (argc > 1 && string(argv[1]) == "sl") methods = { ColoringProblem::ColoringMethod::SmallestLast };
+    if (argc > 1 && string(argv[1]) == "dsatur") methods = { ColoringProblem::ColoringMethod::DSatur };
+    if (argc > 1 && string(argv[1]) == "parallel") methods = { ColoringProblem::ColoringMethod::Parallel };
+    int threads = argc > 2 ? max(1, atoi(argv[2])) : omp_get_max_threads();
+    //Third optional argument: TabuCol wall-clock budget per instance in seconds (0 turns it off)
+    double tabuSeconds = argc > 3 ? atof(argv[3]) : 1.0;
+
     vector<string> files = 
     { 
         "Graphs/myciel3.col", "Graphs/myciel7.col",
@@ -164,23 +26,69 @@ int main()
         "Graphs/le450_5a.col", "Graphs/le450_15b.col",
         "Graphs/queen11_11.col"
     };
+
+    //One column pair per method
+    ostringstream header;
+    header << "Instance";
+    for (auto method : methods)
+    {
+        string name = method == ColoringProblem::ColoringMethod::DSatur ? "DSATUR"
+            : method == ColoringProblem::ColoringMethod::Parallel ? "Parallel" : "Smallest-last";
+        header << "; " << name << " colors; " << name << " time (sec)";
+        if (method == ColoringProblem::ColoringMethod::Parallel) header << "; Parallel rounds";
+    }
+    if (tabuSeconds > 0) header << "; TabuCol colors; TabuCol time (sec)";
+    header << "; Degeneracy; Memory (KB)\n";
+
     ofstream fout("color.csv");
-    fout << "Instance; Colors; Time (sec)\n";
-    cout << "Instance; Colors; Time (sec)\n";
+    fout << header.str();
+    cout << header.str();
     for (string file : files)
     {
         ColoringProblem problem;
         problem.ReadGraphFile(file);
-        clock_t start = clock();
-        problem.GreedyGraphColoring();
-        if (! problem.Check())
+        problem.SetThreads(threads);
+        ostringstream line;
+        line << file;
+        auto bestMethod = methods.front();
+        int bestColors = 0;
+        for (auto method : methods)
         {
-            fout << "*** WARNING: incorrect coloring: ***\n";
-            cout << "*** WARNING: incorrect coloring: ***\n";
+            auto start = chrono::steady_clock::now();
+            problem.Color(method);
+            if (! problem.Check())
+            {
+                fout << "*** WARNING: incorrect coloring: ***\n";
+                cout << "*** WARNING: incorrect coloring: ***\n";
+            }
+            line << "; " << problem.GetNumberOfColors() << "; " << chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (method == ColoringProblem::ColoringMethod::Parallel) line << "; " << problem.GetRounds();
+            if (bestColors == 0 || problem.GetNumberOfColors() < bestColors)
+            {
+                bestMethod = method;
+                bestColors = problem.GetNumberOfColors();
+            }
+        }
+        //TabuCol starts from the best of the colorings above
+        if (tabuSeconds > 0)
+        {
+            problem.Color(bestMethod);
+            problem.TabuColReduction(tabuSeconds);
+            if (! problem.Check())
+            {
+                fout << "*** WARNING: incorrect coloring: ***\n";
+                cout << "*** WARNING: incorrect coloring: ***\n";
+            }
+            line << "; " << problem.GetNumberOfColors() << "; " << problem.GetElapsedSeconds();
         }
-        fout << file << "; " << problem.GetNumberOfColors() << "; " << double(clock() - start) / 1000 << '\n';
-        cout << file << "; " << problem.GetNumberOfColors() << "; " << double(clock() - start) / 1000 << '\n';
+        //Degeneracy is a by-product of the smallest-last order (not used by DSATUR)
+        if (methods.size() > 1 || methods.front() != ColoringProblem::ColoringMethod::DSatur) line << "; " << problem.GetDegeneracy();
+        else line << "; -";
+        line << "; " << problem.GetMemoryFootprint() / 1024 << '\n';
+        fout << line.str();
+        cout << line.str();
+        perf_counters::Report(cout, file);
     }
     fout.close();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <random>
+#include <omp.h>
+#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include "../../Common/bitset.h"
+#include "../../Common/graph_cache.h"
+#include "../../Common/perf_counters.h"
+#include "../../Common/solver.h"
+using namespace std;
+
+
+//Anytime controls come from AnytimeSolver (Common/solver.h): one iteration is one construction,
+//the iteration budget caps `iterations` of FindClique
+class MaxCliqueProblem : public AnytimeSolver
+{
+public:
+    void ReadGraphFile(string filename)
+    {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Load);
+        // The bitset rows of the cached graph are used directly as neighbourhoods;
+        // graphs loaded without them (large and sparse, see Graph::WantsMatrix) use the neighbour lists
+        graph = LoadGraph(filename);
+    }
+
+    //Choosing scalar or AVX2 bitset kernels (Auto picks AVX2 when the CPU has it)
+    void SetKernel(bits::Kernel kernel)
+    {
+        kernels = &bits::SelectKernels(kernel);
+    }
+
+    const char* GetKernelName() const
+    {
+        return kernels->name;
+    }
+
+    //Cutting constructions with the greedy coloring bound of the candidates as well
+    //(the size bound |clique| + |candidates| is always on); needs the bitset rows, so graphs
+    //without them keep the size bound only
+    void SetColoringBound(bool enabled)
+    {
+        coloring_bound = enabled;
+    }
+
+    //Base seed of the per-thread generators (thread t uses seed + t)
+    void Seed(unsigned base)
+    {
+        seed = base;
+    }
+
+    //Constructions of the last FindClique abandoned because they could not beat the best clique
+    long long GetAbortedIterations()
+    {
+        return aborted_iterations;
+    }
+
+    void FindClique(int randomization, int iterations)
+    {
+        StartRun();
+        iterations = (int)min<long long>(iterations, IterationLimit());
+
+        //Best solution found across all threads
+        mutex best_mutex;
+
+        //Its size, shared without locking so every construction can see whether it can still win
+        atomic<int> best_size{(int)best_clique.size()};
+        atomic<long long> aborted{0};
+
+        //Iterations are handed out one at a time (as schedule(dynamic) would), so that every thread
+        //leaves right away once the time budget runs out or the run is cancelled
+        atomic<int> next_iter{0};
+
+        //Parallelism
+        #pragma omp parallel
+        {
+            //Unique random generator for each thread to avoid overlapping sequences
+            mt19937 gen(seed + omp_get_thread_num());
+
+            //Best solution for the current thread
+            vector<int> thread_best;
+
+            //Number of vertices and words in a bitset row
+            int n = graph.Size();
+            int words = graph.RowWords();
+            bool matrix = graph.HasMatrix();
+
+            //Candidate set as a bitset and reusable buffers
+            vector<bits::Word> candidates(words), next(words), removed(words);
+            vector<pair<int,int>> scored;
+            scored.reserve(n);
+
+            //Buffers for the coloring bound
+            vector<bits::Word> uncolored(words), color_class(words);
+            long long thread_aborted = 0;
+
+            //Greedy score of every candidate: degree[v] = |N(v) ∩ candidates|
+            vector<int> degree(n);
+            double density = n > 1 ? 2.0 * graph.EdgeCount() / ((double)n * (n - 1)) : 0.0;
+
+            //Paralleling the iterations
+            while (true)
+            {
+                int iter = next_iter.fetch_add(1, memory_order_relaxed);
+                if (iter >= iterations || ShouldStop())
+                    break;
+                perf_counters::ScopedPhase phase(perf_counters::Phase::Construction);
+
+                //Current clique
+                vector<int> clique;
+
+                //Candidates for expanding the clique (everything at first, so the scores are the degrees)
+                bits::Fill(candidates.data(), n);
+                for (int v = 0; v < n; ++v)
+                    degree[v] = graph.Degree(v);
+                int count = n;
+
+                //As long as there are candidates to add to the clique
+                bool hopeless = false;
+                while (count > 0)
+                {
+                    //Beating the best clique needs need + 1 more vertices: aborting if there are
+                    //not as many candidates, or not as many with a score of at least need
+                    //(every vertex of such a clique has the others as candidate neighbours)
+                    int need = best_size.load(memory_order_relaxed) - (int)clique.size();
+                    if (count <= need)
+                    {
+                        hopeless = true;
+                        break;
+                    }
+
+                    //Estimation-vertex vector
+                    scored.clear();
+                    int strong = 0;
+                    bits::ForEach(candidates.data(), words, [&](int v)
+                    {
+                        scored.emplace_back(degree[v], v);
+                        if (degree[v] >= need) ++strong;
+                    });
+                    if (strong <= need)
+                    {
+                        hopeless = true;
+                        break;
+                    }
+
+                    //Optionally the same with the number of color classes, only close to the
+                    //threshold where it is likely to succeed (coloring costs about a construction step)
+                    if (coloring_bound && matrix && count <= 2 * need &&
+                        ColorCount(candidates.data(), need, uncolored, color_class) <= need)
+                    {
+                        hopeless = true;
+                        break;
+                    }
+
+                    //Resctricted Candidate List: only the R best scores are needed, not a full sort
+                    int R = max(1, min(
+                        randomization,
+                        (int)scored.size()
+                    ));
+                    nth_element(scored.begin(), scored.begin() + (R - 1), scored.end(),
+                        [](const auto& a, const auto& b)
+                        {
+                            return a.first > b.first;
+                        });
+
+                    //Randomly choosing a vertex from RCL
+                    uniform_int_distribution<int> dist(0, R - 1);
+                    int v = scored[dist(gen)].second;
+
+                    //Adding chosen vertex to the clique
+                    clique.push_back(v);
+
+                    //Filtering the candidates with a single AND (v is not in its own row),
+                    //the dropped ones (v included) are kept to update the scores
+                    if (matrix)
+                    {
+                        kernels->and_into(next.data(), candidates.data(), graph.Row(v), words);
+                        kernels->and_not_into(removed.data(), candidates.data(), graph.Row(v), words);
+                    }
+                    else
+                    {
+                        //Without the matrix the kept candidates are the neighbours of v still in the set
+                        bits::Clear(next.data(), words);
+                        for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+                            if (bits::Test(candidates.data(), *u)) bits::Set(next.data(), *u);
+                        for (int w = 0; w < words; ++w)
+                            removed[w] = candidates[w] & ~next[w];
+                    }
+                    int nextCount = bits::Count(next.data(), words);
+
+                    //Updating the scores of the remaining candidates: every dropped vertex takes one
+                    //off each of its remaining neighbours (about nextCount * density of them), which over
+                    //an iteration sums up to the degrees; recounting costs a row AND per kept vertex.
+                    //The cheaper of the two is used, so dense graphs mostly recount.
+                    //Without the matrix only the decrements are possible, walking the neighbour lists.
+                    double decrementCost = (count - nextCount) * (words + nextCount * density);
+                    if (!matrix)
+                    {
+                        bits::ForEach(removed.data(), words, [&](int u)
+                        {
+                            for (const int* x = graph.NeighboursBegin(u); x != graph.NeighboursEnd(u); ++x)
+                                if (bits::Test(next.data(), *x)) --degree[*x];
+                        });
+                    }
+                    else if (decrementCost < (double)nextCount * words)
+                    {
+                        bits::ForEach(removed.data(), words, [&](int u)
+                        {
+                            const bits::Word* row = graph.Row(u);
+                            for (int w = 0; w < words; ++w)
+                                for (bits::Word m = row[w] & next[w]; m; m &= m - 1)
+                                    --degree[w * 64 + countr_zero(m)];
+                        });
+                    }
+                    else
+                    {
+                        bits::ForEach(next.data(), words, [&](int u)
+                        {
+                            degree[u] = kernels->and_count(graph.Row(u), next.data(), words);
+                        });
+                    }
+                    candidates.swap(next);
+                    count = nextCount;
+                }
+
+                if (hopeless)
+                {
+                    ++thread_aborted;
+                    continue;
+                }
+
+                // Updating the best solution found by the current thread and the shared size
+                if (clique.size() > thread_best.size())
+                {
+                    int size = clique.size();
+                    thread_best = move(clique);
+                    int seen = best_size.load(memory_order_relaxed);
+                    while (size > seen && !best_size.compare_exchange_weak(seen, size, memory_order_relaxed))
+                        ;
+                    if (size > seen)
+                        Report(size, -1, iter + 1);
+                }
+            }
+            aborted += thread_aborted;
+
+            //Updating the best global solution if need be
+            lock_guard<mutex> lock(best_mutex);
+            if (thread_best.size() > best_clique.size())
+                best_clique = move(thread_best);
+        }
+        aborted_iterations = aborted;
+    }
+
+    const vector<int>& GetClique()
+    {
+        return best_clique;
+    }
+
+    bool Check()
+    {
+        if (unique(best_clique.begin(), best_clique.end()) != best_clique.end())
+        {
+            cout << "Duplicated vertices in the clique\n";
+            return false;
+        }
+        for (int i : best_clique)
+        {
+            for (int j : best_clique)
+            {
+                if (i != j && !graph.HasEdge(i, j))
+                {
+                    cout << "Returned subgraph is not a clique\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    Graph graph;
+    vector<int> best_clique;
+    bool coloring_bound = false;
+    long long aborted_iterations = 0;
+    unsigned seed = 123456;
+
+    //Number of color classes of a greedy coloring of the candidate set (an upper bound on any
+    //clique inside it); stops counting as soon as it exceeds limit
+    int ColorCount(const bits::Word* candidates, int limit, vector<bits::Word>& uncolored, vector<bits::Word>& color_class)
+    {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Coloring);
+        int words = graph.RowWords();
+        copy(candidates, candidates + words, uncolored.begin());
+        int colors = 0;
+        int first = 0;
+        while (true)
+        {
+            while (first < words && uncolored[first] == 0) ++first;
+            if (first == words) return colors;
+            if (++colors > limit) return colors;
+
+            //One color class: repeatedly taking the first vertex and dropping its neighbours
+            copy(uncolored.begin(), uncolored.end(), color_class.begin());
+            for (int w = first; w < words; ++w)
+                while (color_class[w])
+                {
+                    int v = w * 64 + countr_zero(color_class[w]);
+                    bits::Reset(uncolored.data(), v);
+                    kernels->and_not_into(color_class.data(), color_class.data(), graph.Row(v), words);
+                    bits::Reset(color_class.data(), v);
+                }
+        }
+    }
+    const bits::Kernels* kernels = &bits::SelectKernels();
+};
@@ -1,179 +1,18 @@
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <vector>
-#include <sstream>
-#include <time.h>
-#include <random>
-#include <omp.h>
-#include <mutex>
-#include <unordered_set>
-#include <algorithm>
-using namespace std;
+#include "../../Common/alloc_counter.h"
+#include "grasp.h"
 
+//Counting heap allocations for the per-phase profile (LAB_PROFILE=1)
+ALLOC_COUNTER_INSTALL()
 
-class MaxCliqueProblem
-{
-public:
-    static int GetRandom(int a, int b)
-    {
-        static mt19937 generator;
-        uniform_int_distribution<int> uniform(a, b);
-        return uniform(generator);
-    }
-
-    void ReadGraphFile(string filename)
-    {
-        ifstream fin(filename);
-        string line;
-        int vertices = 0, edges = 0;
-        while (getline(fin, line))
-        {
-            if (line[0] == 'c')
-            {
-                continue;
-            }
-
-            stringstream line_input(line);
-            char command;
-            if (line[0] == 'p')
-            {
-                string type;
-                line_input >> command >> type >> vertices >> edges;
-                neighbour_sets.resize(vertices);
-            }
-            else
-            {
-                int start, finish;
-                line_input >> command >> start >> finish;
-                // Edges in DIMACS file can be repeated, but it is not a problem for our sets
-                neighbour_sets[start - 1].insert(finish - 1);
-                neighbour_sets[finish - 1].insert(start - 1);
-            }
-        }
-    }
-
-    void FindClique(int randomization, int iterations)
-    {
-        //Best solution found across all threads
-        mutex best_mutex;
-
-        //Parallelism
-        #pragma omp parallel
-        {
-            //Unique random generator for each thread to avoid overlapping sequences
-            mt19937 gen(123456 + omp_get_thread_num());
-
-            //Best solution for the current thread
-            vector<int> thread_best;
-
-            //Paralleling the iterations
-            #pragma omp for schedule(dynamic)
-            for (int iter = 0; iter < iterations; ++iter)
-            {
-                //Current clique
-                vector<int> clique;
-
-                //Candidates for expanding the clique
-                vector<int> candidates(neighbour_sets.size());
-                iota(candidates.begin(), candidates.end(), 0);
-
-                //As long as there are candidates to add to the clique
-                while (!candidates.empty())
-                {
-                    //Estimation-vertex vector
-                    vector<pair<int,int>> scored;
-                    scored.reserve(candidates.size());
-
-                    //Computing the greedy score for each candidate vertex
-                    for (int v : candidates)
-                    {
-                        int deg = 0;
-                        for (int u : candidates)
-                            if (u != v && neighbour_sets[v].count(u))
-                                ++deg;
-
-                        // deg = |N(v) ∩ candidates|
-                        scored.emplace_back(deg, v);
-                    }
-
-                    //Sorting by greedy score
-                    sort(scored.begin(), scored.end(),
-                        [](const auto& a, const auto& b)
-                        {
-                            return a.first > b.first;
-                        });
-
-                    //Resctricted Candidate List
-                    int R = max(1, min(
-                        randomization,
-                        (int)scored.size()
-                    ));
-
-                    //Randomly choosing a vertex from RCL
-                    uniform_int_distribution<int> dist(0, R - 1);
-                    int v = scored[dist(gen)].second;
-
-                    //Adding chosen vertex to the clique
-                    clique.push_back(v);
-
-                    //Filtering the candidates list
-                    vector<int> new_candidates;
-                    for (int u : candidates)
-                    {
-                        if (u != v && neighbour_sets[v].count(u))
-                            new_candidates.push_back(u);
-                    }
-
-                    //Updating candidates
-                    candidates.swap(new_candidates);
-                }
-
-                // Updating the best solution found by the current thread
-                if (clique.size() > thread_best.size())
-                    thread_best = move(clique);
-            }
-
-            //Updating the best global solution if need be
-            lock_guard<mutex> lock(best_mutex);
-            if (thread_best.size() > best_clique.size())
-                best_clique = move(thread_best);
-        }
-    }
-
-    const vector<int>& GetClique()
-    {
-        return best_clique;
-    }
-
-    bool Check()
-    {
-        if (unique(best_clique.begin(), best_clique.end()) != best_clique.end())
-        {
-            cout << "Duplicated vertices in the clique\n";
-            return false;
-        }
-        for (int i : best_clique)
-        {
-            for (int j : best_clique)
-            {
-                if (i != j && neighbour_sets[i].count(j) == 0)
-                {
-                    cout << "Returned subgraph is not a clique\n";
-                    return false;
-                }
-            }
-        }
-        return true;
-    }
-
-private:
-    vector<unordered_set<int>> neighbour_sets;
-    vector<int> best_clique;
-};
 
-int main()
+int main(int argc, char* argv[])
 {
+    //Optional argument: bitset kernels to use (auto, scalar or avx2)
+    bits::Kernel kernel = argc > 1 ? bits::ParseKernel(argv[1]) : bits::Kernel::Auto;
+    //Second optional argument: "color" turns on the coloring bound for aborting constructions
+    bool coloring_bound = argc > 2 && string(argv[2]) == "color";
+    //Third optional argument: time limit per graph in seconds
+    double time_limit = argc > 3 ? atof(argv[3]) : numeric_limits<double>::infinity();
     int iterations;
     cout << "Number of iterations: ";
     cin >> iterations;
@@ -213,15 +52,20 @@ int main()
     {
         MaxCliqueProblem problem;
         problem.ReadGraphFile(file);
-        clock_t start = clock();
+        problem.SetKernel(kernel);
+        problem.SetColoringBound(coloring_bound);
+        problem.SetTimeLimit(time_limit);
         problem.FindClique(randomization, iterations);
         if (! problem.Check())
         {
             cout << "*** WARNING: incorrect clique ***\n";
             fout << "*** WARNING: incorrect clique ***\n";
         }
-        fout << file << "; " << problem.GetClique().size() << "; " << double(clock() - start) / 1000 << '\n';
-        cout << file << ", result - " << problem.GetClique().size() << ", time - " << double(clock() - start) / 1000 << '\n';
+        double time = problem.GetElapsedSeconds();
+        fout << file << "; " << problem.GetClique().size() << "; " << time << '\n';
+        cout << file << ", result - " << problem.GetClique().size() << ", time - " << time
+             << ", aborted constructions - " << problem.GetAbortedIterations() << '\n';
+        perf_counters::Report(cout, file);
     }
     fout.close();
     return 0;
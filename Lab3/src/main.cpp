@@ -1,14 +1,19 @@
+#include <omp.h>
 #include "tabu.h"
+#include "../../Common/alloc_counter.h"
+#include "../../Common/resource_usage.h"
 
+// Counting heap allocations for the per-phase profile (LAB_PROFILE=1)
+ALLOC_COUNTER_INSTALL()
 
-int main()
+
+int main(int argc, char* argv[])
 {
+    // Optional argument: number of search threads (all available by default)
+    int threads = argc > 1 ? max(1, atoi(argv[1])) : omp_get_max_threads();
     int iterations;
     cout << "Number of iterations: ";
     cin >> iterations;
-    int randomization;
-    cout << "Randomization: ";
-    cin >> randomization;
     
     vector<string> files = 
     { 
@@ -40,14 +45,14 @@ int main()
     };
     
     ofstream fout("clique_tabu.csv");
-    fout << "File; Clique; Time (sec)\n";
+    fout << "File; Clique; Time (sec); Setup (sec); Solver memory (KB); Resident (KB); Peak resident (KB)\n";
     
     for (string file : files)
     {
         MaxCliqueTabuSearch problem;
         problem.ReadGraphFile(file);
-        clock_t start = clock();
-        problem.RunSearch(iterations, randomization);
+        problem.SetThreads(threads);
+        problem.RunSearch(iterations);
         
         if (!problem.Check())
         {
@@ -55,9 +60,16 @@ int main()
             fout << "*** WARNING: incorrect clique ***\n";
         }
         
-        double time_taken = double(clock() - start) / CLOCKS_PER_SEC;
-        fout << file << "; " << problem.GetClique().size() << "; " << time_taken << '\n';
-        cout << file << ", result - " << problem.GetClique().size() << ", time - " << time_taken << " sec\n";
+        // Wall-clock time of the search (steady clock); setup is loading plus the stored complement
+        double time_taken = problem.GetElapsedSeconds();
+        long long resident = resource_usage::CurrentResidentBytes() / 1024;
+        long long peak = resource_usage::PeakResidentBytes() / 1024;
+        fout << file << "; " << problem.GetClique().size() << "; " << time_taken << "; " << problem.GetSetupSeconds()
+             << "; " << problem.GetMemoryFootprint() / 1024 << "; " << resident << "; " << peak << '\n';
+        cout << file << ", result - " << problem.GetClique().size() << ", time - " << time_taken << " sec"
+             << ", setup - " << problem.GetSetupSeconds() << " sec, memory - " << problem.GetMemoryFootprint() / 1024
+             << " KB, resident - " << resident << " KB (peak " << peak << " KB)\n";
+        perf_counters::Report(cout, file);
     }
     
     fout.close();
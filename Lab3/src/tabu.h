@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -7,12 +9,43 @@
 #include <random>
 #include <unordered_set>
 #include <algorithm>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "../../Common/bitset.h"
+#include "../../Common/graph_cache.h"
+#include "../../Common/perf_counters.h"
+#include "../../Common/solver.h"
 using namespace std;
 
 
-class MaxCliqueTabuSearch
+// Anytime controls (Common/solver.h): the iteration unit is one start of RunSearch;
+// without SetTimeLimit a run gets clamp(0.05 s per vertex, 10 s, 120 s)
+class MaxCliqueTabuSearch : public AnytimeSolver
 {
 public:
+    // A clique as a sorted vertex list plus the same set as a bitset, and a 64-bit
+    // fingerprint of the set so that duplicates are spotted without comparing the sets
+    struct Solution
+    {
+        vector<int> vertices;
+        vector<bits::Word> members;
+        uint64_t fingerprint = 0;
+
+        int Size() const
+        {
+            return (int)vertices.size();
+        }
+
+        bool operator==(const Solution& other) const
+        {
+            return fingerprint == other.fingerprint && vertices == other.vertices;
+        }
+    };
 
     int GetRandom(int a, int b)
     {
@@ -23,68 +56,94 @@ public:
 
     void ReadGraphFile(string filename)
     {
-        ifstream fin(filename);
-        string line;
-        int vertices = 0, edges = 0;
-        while (getline(fin, line))
+        auto start = chrono::steady_clock::now();
+        Graph loaded;
         {
-            if (line[0] == 'c')
-            {
-                continue;
-            }
-
-            stringstream line_input(line);
-            char command;
-            if (line[0] == 'p')
-            {
-                string type;
-                line_input >> command >> type >> vertices >> edges;
-                neighbour_sets.resize(vertices);
-                qco.resize(vertices);
-                index.resize(vertices, -1);
-                non_neighbours.resize(vertices);
-            }
-            else
-            {
-                int start, finish;
-                line_input >> command >> start >> finish;
-                // Edges in DIMACS file can be repeated, but it is not a problem for our sets
-                neighbour_sets[start - 1].insert(finish - 1);
-                neighbour_sets[finish - 1].insert(start - 1);
-            }
+            perf_counters::ScopedPhase phase(perf_counters::Phase::Load);
+            // Repeated edges are already dropped by the shared loader (see Common/graph_cache.h)
+            loaded = LoadGraph(filename);
         }
-        for (int i = 0; i < vertices; ++i)
+        SetGraph(loaded);
+        rng.seed((unsigned)time(nullptr));
+        setup_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Takes the adjacency straight from a shared Graph (used when running next to Lab4's BnB);
+    // copies of a Graph share its storage, so the adjacency (bitset rows when the graph has them)
+    // is used as is. The complement, which every move walks, is stored as a CSR of non-neighbours
+    // only while it stays small: up to Graph::kSmallGraphVertices, or when it is no larger than
+    // the adjacency (dense graphs). Otherwise it has about n^2 / 2 entries and the moves scan it
+    // on the fly instead (see ForEachNonNeighbour)
+    void SetGraph(const Graph& source)
+    {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Preprocessing);
+        auto start = chrono::steady_clock::now();
+        graph = source;
+        int n = graph.Size();
+        long long non_edges = max<long long>(0, (long long)n * (n - 1) - 2 * graph.EdgeCount());
+        complement = nullptr;
+        if (n <= Graph::kSmallGraphVertices || non_edges <= 2 * graph.EdgeCount())
         {
-            for (int j = 0; j < vertices; ++j)
+            auto lists = make_shared<NonNeighbourLists>();
+            lists->offsets.assign(n + 1, 0);
+            lists->adj.reserve(non_edges);
+            for (int v = 0; v < n; ++v)
             {
-                if (neighbour_sets[i].count(j) == 0 && i != j)
-                    non_neighbours[i].insert(j);
+                ForEachNonNeighbour(v, [&](int u) { lists->adj.push_back(u); });
+                lists->offsets[v + 1] = (int64_t)lists->adj.size();
             }
+            complement = move(lists);
         }
+        ResetWorkingArrays();
+        setup_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
 
-        rng.seed((unsigned)time(nullptr));
+    void Seed(unsigned seed)
+    {
+        rng.seed(seed);
+    }
+
+    // Called with the new best clique every time RunSearch improves it
+    void SetImprovementCallback(function<void(const vector<int>&)> callback)
+    {
+        on_improvement = move(callback);
     }
 
     void SetNeighbourSets(const std::vector<std::unordered_set<int>>& ns)
     {
-        neighbour_sets = ns;
+        // Строим общий граф (CSR + битовая матрица), дополнение строит SetGraph
+        vector<pair<int, int>> edges;
+        for (int i = 0; i < (int)ns.size(); ++i)
+            for (int j : ns[i])
+                if (i < j) edges.emplace_back(i, j);
+        SetGraph(Graph::FromEdges((int)ns.size(), edges));
+    }
 
-        int n = neighbour_sets.size();
+    // Wall-clock seconds of the last ReadGraphFile / SetGraph (loading plus the stored complement)
+    double GetSetupSeconds() const
+    {
+        return setup_seconds;
+    }
+
+    // Bytes held by the adjacency, the non-neighbour CSR (if stored) and the working arrays
+    long long GetMemoryFootprint() const
+    {
+        long long bytes = graph.MemoryBytes();
+        if (complement)
+            bytes += (long long)complement->adj.capacity() * sizeof(int)
+                + (long long)complement->offsets.capacity() * sizeof(int64_t);
+        return bytes + (long long)(qco.capacity() + index.capacity() + tightness.capacity()) * sizeof(int);
+    }
+
+    void ResetWorkingArrays()
+    {
+        int n = graph.Size();
 
         // Основные рабочие массивы
         qco.resize(n);
         index.assign(n, -1);
         tightness.assign(n, 0);
-
-        // Строим множества несмежных вершин
-        non_neighbours.resize(n);
-        for (int i = 0; i < n; ++i) {
-            non_neighbours[i].clear();
-            for (int j = 0; j < n; ++j) {
-                if (i != j && neighbour_sets[i].count(j) == 0)
-                    non_neighbours[i].insert(j);
-            }
-        }
+        tabu_until.assign(n, 0);
 
         // Сбрасываем текущее и лучшее решение
         best_clique.clear();
@@ -97,104 +156,68 @@ public:
         // Построение индексов
         RebuildIndex();
 
-        // Инициализация tightness для пустой клики
+        // Инициализация tightness для пустой клики (все вершины — кандидаты)
         RebuildTightness();
+        RebuildBorders();
     }
 
-    void RunSearch(int starts, int randomization)
+    // Number of threads running starts in parallel (OpenMP). Every thread has its own working
+    // arrays (qco, index, tightness) and random generator over the shared read-only graph and
+    // complement; the threads exchange solutions through the elite pool used for path relinking
+    void SetThreads(int count)
     {
-        // Elite pool for path-relinking (keeps a few best solutions)
-        vector<unordered_set<int>> elite;
-        const int ELITE_MAX = 3;
-        const int PR_FREQ = 5; // only attempt path-relinking every PR_FREQ starts
+        threads = max(1, count);
+    }
 
-        // per-instance budgets
-        // time_limit_seconds
-        int n = (int)neighbour_sets.size();
-        double time_limit_seconds = max(10.0, n * 0.05); // simple heuristic: 0.05s per vertex, min 10s
-        if (time_limit_seconds > 120.0) time_limit_seconds = 120.0;
-        clock_t global_start = clock();
+    void RunSearch(int starts)
+    {
+        // Default budget when none is set: 0.05s per vertex, between 10s and 120s
+        int n = graph.Size();
+        StartRun(clamp(n * 0.05, 10.0, 120.0));
 
-        for (int iter = 0; iter < starts; ++iter)
+        ElitePool elite;
+        atomic<int> next_start{0};
+        if (threads == 1)
         {
-            // check global time budget
-            double elapsed = double(clock() - global_start) / CLOCKS_PER_SEC;
-            if (elapsed > time_limit_seconds) break;
-            // Initialize working arrays
-            ClearClique();
-            for (size_t i = 0; i < neighbour_sets.size(); ++i)
-            {
-                qco[i] = i;
-                index[i] = i;
-            }
-
-            // GRASP construction
-            cur_randomization = randomization;
-            RunInitialHeuristic(randomization);
-            c_border = q_border;
-
-            // Local search to improve the constructed solution (budget proportional to graph size)
-            int ls_budget = max(20, n / 10);
-            LocalSearch(ls_budget);
-
-            // Capture current solution
-            unordered_set<int> current = CaptureCurrentClique();
-
-            // Path relinking: try combining with a random elite member occasionally
-            if (!elite.empty() && (iter % PR_FREQ == 0))
-            {
-                int r = GetRandom(0, (int)elite.size() - 1);
-                unordered_set<int> pr_candidate = PathRelink(current, elite[r]);
-                if (pr_candidate.size() > current.size())
-                {
-                    current = pr_candidate;
-                    RestoreClique(current);
-                    RebuildIndex();
-                    int ls_budget2 = max(10, n / 20);
-                    LocalSearch(ls_budget2);
-                }
-            }
-
-            // Shake / rebuild: perturb and re-search
-            PerturbeClique(randomization);
-            RebuildIndex();
-            int ls_budget3 = max(10, n / 20);
-            LocalSearch(ls_budget3);
-            current = CaptureCurrentClique();
+            RunStarts(*this, elite, next_start, starts);
+            return;
+        }
 
-            // Insert into elite pool if good
-            if (current.size() > 0)
-            {
-                // maintain unique elites
-                bool inserted = false;
-                for (auto &e : elite)
-                {
-                    if (e == current) { inserted = true; break; }
-                }
-                if (!inserted)
-                {
-                    elite.push_back(current);
-                    sort(elite.begin(), elite.end(), [](const unordered_set<int>&a,const unordered_set<int>&b){return a.size()>b.size();});
-                    if ((int)elite.size() > ELITE_MAX) elite.pop_back();
-                }
-            }
+        unsigned base_seed = rng();
+        atomic<int> next_worker{0};
+        #pragma omp parallel num_threads(threads)
+        {
+            MaxCliqueTabuSearch worker;
+            worker.ShareGraph(*this);
+            worker.Seed(base_seed + next_worker.fetch_add(1));
+            worker.RunStarts(*this, elite, next_start, starts);
+        }
+    }
 
-            // Update global best
-            if (current.size() > best_clique.size())
-            {
-                best_clique = current;
-            }
+    Solution MakeSolution(vector<int> vertices) const
+    {
+        Solution solution;
+        sort(vertices.begin(), vertices.end());
+        solution.members.assign(bits::Words(graph.Size()), 0);
+        // Order-independent: a sum of mixed (splitmix64) vertex ids
+        for (int v : vertices)
+        {
+            bits::Set(solution.members.data(), v);
+            uint64_t z = (uint64_t)v + 0x9E3779B97F4A7C15ull;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            solution.fingerprint += z ^ (z >> 31);
         }
+        solution.vertices = move(vertices);
+        return solution;
     }
 
-    unordered_set<int> CaptureCurrentClique()
+    Solution CaptureCurrentClique()
     {
-        unordered_set<int> s;
-        for (int i = 0; i < q_border; ++i) s.insert(qco[i]);
-        return s;
+        return MakeSolution(vector<int>(qco.begin(), qco.begin() + q_border));
     }
 
-    void RestoreClique(const unordered_set<int>& solution)
+    void RestoreClique(const vector<int>& solution)
     {
         ClearClique();
         // place solution vertices at front of qco and fill rest with remaining vertices
@@ -220,10 +243,10 @@ public:
         // rebuild borders
         q_border = (int)solution.size();
         if (q_border > n) q_border = n;
-        c_border = q_border;
         // ensure indices are consistent
         RebuildIndex();
         RebuildTightness();
+        RebuildBorders();
     }
 
     // RebuildIndex: rebuild the `index` mapping from `qco` positions to
@@ -240,83 +263,101 @@ public:
         }
     }
 
+    // Tabu local search: greedy additions, then a plateau swap (1-1 exchange) or, when every
+    // swap is tabu, a drop. A vertex that leaves the clique may not come back and a vertex
+    // that enters may not leave for a randomized tenure (see Tenure); a tabu vertex may
+    // still be added when that beats the best clique of this search (aspiration).
+    // The search ends with the best clique it has seen.
     void LocalSearch(int max_iterations)
     {
-        int it = 0;
+        perf_counters::ScopedPhase phase(perf_counters::Phase::LocalSearch);
         int no_improve = 0;
         int best = q_border;
-        while (it < max_iterations && no_improve < 25)
+        best_local.assign(qco.begin(), qco.begin() + q_border);
+        for (int it = 0; it < max_iterations && no_improve < 25 && !owner->ShouldStop(); ++it)
         {
-            int before = q_border;
             // Greedy additions
-            while (Move()) { if (q_border > best) { best = q_border; no_improve = 0; } }
-            // Swaps
-            if (!Swap1To1()) no_improve++; else { if (q_border>best) best=q_border; no_improve=0; }
-            if (q_border == before) no_improve++;
-            ++it;
+            while (Move(best)) ;
+            if (q_border > best)
+            {
+                best = q_border;
+                best_local.assign(qco.begin(), qco.begin() + q_border);
+                no_improve = 0;
+            }
+            else
+            {
+                ++no_improve;
+            }
+            // Plateau or drop move
+            if (!Swap1To1()) Drop();
         }
+        while (Move(best)) ;
+        if (q_border < best)
+            RestoreClique(best_local);
     }
 
-    void PerturbeClique(int randomization)
+    void PerturbeClique()
     {
         if (q_border <= 1) return;
-        int n = (int)neighbour_sets.size();
-        double frac = (n > 1000) ? 0.07 : 0.12;
-        int remove_cnt = max(1, (int)(q_border * frac));
-        for (int r = 0; r < remove_cnt && q_border>1; ++r)
         {
-            int idx = GetRandom(0, q_border - 1);
-            int v = qco[idx];
-            RemoveFromClique(v);
+            // Only the removals: the rebuild below is measured by RunInitialHeuristic itself
+            perf_counters::ScopedPhase phase(perf_counters::Phase::Construction);
+            int n = graph.Size();
+            double frac = (n > 1000) ? 0.07 : 0.12;
+            int remove_cnt = max(1, (int)(q_border * frac));
+            for (int r = 0; r < remove_cnt && q_border>1; ++r)
+            {
+                int idx = GetRandom(0, q_border - 1);
+                int v = qco[idx];
+                RemoveFromClique(v);
+            }
         }
-        c_border = q_border;
         // try a brief rebuild
-        RunInitialHeuristic(max(2, randomization/2));
+        RunInitialHeuristic();
         RebuildIndex();
-        c_border = q_border;
     }
 
-    unordered_set<int> PathRelink(const unordered_set<int>& A, const unordered_set<int>& B)
+    // Moves from A towards B: adds vertices of B\A compatible with the whole clique, picked at
+    // random, until none is left. The vertices compatible with the clique are its common
+    // neighbourhood, kept as a bitset: each added vertex costs one AND with its row, O(n/64)
+    Solution PathRelink(const Solution& A, const Solution& B)
     {
-        // Move from A towards B: iteratively try to add vertices from B\A when feasible
-        unordered_set<int> current = A;
-        unordered_set<int> target = B;
-        unordered_set<int> best = current;
-        bool improved = true;
-        while (improved)
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Construction);
+        int words = bits::Words(graph.Size());
+        vector<bits::Word>& common = relink_common;
+        common = B.members;
+        for (int w = 0; w < words; ++w) common[w] &= ~A.members[w];
+        for (int u : A.vertices) AndRow(common.data(), u);
+
+        vector<int> vertices = A.vertices;
+        for (int count = bits::Count(common.data(), words); count > 0; count = bits::Count(common.data(), words))
         {
-            improved = false;
-            // candidates in B not in current
-            for (int v : target)
-            {
-                if (current.count(v)) continue;
-                bool compatible = true;
-                for (int u : current)
-                    if (neighbour_sets[v].count(u) == 0) { compatible = false; break; }
-                if (compatible)
-                {
-                    current.insert(v);
-                    if (current.size() > best.size()) best = current;
-                    improved = true;
-                    break; // restart
-                }
-            }
+            int v = bits::Select(common.data(), words, GetRandom(0, count - 1));
+            vertices.push_back(v);
+            bits::Reset(common.data(), v);
+            AndRow(common.data(), v);
         }
-        return best;
+        return MakeSolution(move(vertices));
     }
 
-    const unordered_set<int>& GetClique()
+    // Best clique found, vertices in ascending order
+    const vector<int>& GetClique()
     {
         return best_clique;
     }
 
     bool Check()
     {
+        if (adjacent_find(best_clique.begin(), best_clique.end()) != best_clique.end())
+        {
+            cout << "Duplicated vertices in the clique\n";
+            return false;
+        }
         for (int i : best_clique)
         {
             for (int j : best_clique)
             {
-                if (i != j && neighbour_sets[i].count(j) == 0)
+                if (i != j && !graph.HasEdge(i, j))
                 {
                     cout << "Returned subgraph is not clique\n";
                     return false;
@@ -329,22 +370,194 @@ public:
     void ClearClique()
     {
         q_border = 0;
-        c_border = 0;
-        // reset tightness cache
+        // reset tightness cache: with an empty clique every vertex is a candidate
         tightness.assign(qco.size(), 0);
+        c_border = (int)qco.size();
     }
 
 private:
-    vector<unordered_set<int>> neighbour_sets;
-    vector<unordered_set<int>> non_neighbours;
-    unordered_set<int> best_clique;
+    // Elite pool for path-relinking shared by the search threads (keeps a few best distinct solutions)
+    class ElitePool
+    {
+    public:
+        static const int ELITE_MAX = 3;
+
+        void Offer(const Solution& solution)
+        {
+            lock_guard<mutex> lock(pool_mutex);
+            // maintain unique elites (fingerprints first, the lists only when those match)
+            for (auto &e : members)
+            {
+                if (e == solution) return;
+            }
+            members.push_back(solution);
+            sort(members.begin(), members.end(), [](const Solution&a,const Solution&b){return a.Size()>b.Size();});
+            if ((int)members.size() > ELITE_MAX) members.pop_back();
+        }
+
+        // Copies a random member into `out`; false while the pool is empty
+        bool Sample(mt19937& generator, Solution& out)
+        {
+            lock_guard<mutex> lock(pool_mutex);
+            if (members.empty()) return false;
+            uniform_int_distribution<int> uniform(0, (int)members.size() - 1);
+            out = members[uniform(generator)];
+            return true;
+        }
+
+    private:
+        mutex pool_mutex;
+        vector<Solution> members;
+    };
+
+    // Complement in CSR form: non-neighbours of v are adj[offsets[v] .. offsets[v + 1])
+    struct NonNeighbourLists
+    {
+        vector<int> adj;
+        vector<int64_t> offsets;
+    };
+
+    Graph graph;
+    // Shared (read-only) with the workers of a parallel RunSearch; null when not stored (see SetGraph)
+    shared_ptr<const NonNeighbourLists> complement;
+    double setup_seconds = 0;
+    int threads = 1;
+    // Solver whose budget, cancellation and best clique the running starts belong to
+    MaxCliqueTabuSearch* owner = this;
+    mutex best_mutex;
+    vector<int> best_clique;
     vector<int> qco;
     vector<int> index;
     vector<int> tightness;
     mt19937 rng;
 
-    // store last `randomization` parameter used;
-    int cur_randomization = 1;
+    // Calls f(u) for every non-neighbour u of v (u != v), in increasing order: from the stored
+    // complement, else from the inverted matrix row, else by merging 0..n-1 with the sorted
+    // neighbour list (O(n) per call, but no quadratic storage)
+    template <typename F>
+    void ForEachNonNeighbour(int v, F&& f) const
+    {
+        if (complement)
+        {
+            const int* adj = complement->adj.data();
+            for (int64_t i = complement->offsets[v]; i < complement->offsets[v + 1]; ++i)
+                f(adj[i]);
+            return;
+        }
+        int n = graph.Size();
+        if (graph.HasMatrix())
+        {
+            const uint64_t* row = graph.Row(v);
+            for (int w = 0; w < graph.RowWords(); ++w)
+            {
+                uint64_t missing = ~row[w];
+                if (w == graph.RowWords() - 1 && n % 64) missing &= (uint64_t(1) << (n % 64)) - 1;
+                for (; missing; missing &= missing - 1)
+                {
+                    int u = w * 64 + countr_zero(missing);
+                    if (u != v) f(u);
+                }
+            }
+            return;
+        }
+        const int* neighbour = graph.NeighboursBegin(v);
+        for (int u = 0; u < n; ++u)
+        {
+            if (neighbour != graph.NeighboursEnd(v) && *neighbour == u) ++neighbour;
+            else if (u != v) f(u);
+        }
+    }
+
+    // Worker of a parallel RunSearch: same graph and complement, own working arrays
+    void ShareGraph(const MaxCliqueTabuSearch& other)
+    {
+        graph = other.graph;
+        complement = other.complement;
+        ResetWorkingArrays();
+    }
+
+    void OfferBest(const Solution& clique, long long starts_done)
+    {
+        lock_guard<mutex> lock(best_mutex);
+        if (clique.vertices.size() <= best_clique.size()) return;
+        best_clique = clique.vertices;
+        if (on_improvement) on_improvement(best_clique);
+        Report(best_clique.size(), -1, starts_done);
+    }
+
+    // Runs starts taken from next_start until they run out or `parent` has to stop;
+    // the best clique goes to `parent` (which is *this when running single-threaded)
+    void RunStarts(MaxCliqueTabuSearch& parent, ElitePool& elite, atomic<int>& next_start, int starts)
+    {
+        int n = graph.Size();
+        owner = &parent;
+
+        while (true)
+        {
+            // starts are handed out one at a time; check the wall-clock and iteration
+            // budgets and cancellation of the owner
+            int iter = next_start.fetch_add(1, memory_order_relaxed);
+            if (iter >= starts || owner->ShouldStop(iter)) break;
+            // Initialize working arrays
+            ClearClique();
+            for (int i = 0; i < n; ++i)
+            {
+                qco[i] = i;
+                index[i] = i;
+            }
+
+            // GRASP construction
+            RunInitialHeuristic();
+
+            // Local search to improve the constructed solution (budget proportional to graph size)
+            int ls_budget = max(20, n / 10);
+            LocalSearch(ls_budget);
+
+            // Capture current solution
+            Solution current = CaptureCurrentClique();
+
+            // Path relinking with a random elite member (cheap enough with bitsets to do every start)
+            Solution partner;
+            if (elite.Sample(rng, partner))
+            {
+                Solution pr_candidate = PathRelink(current, partner);
+                if (pr_candidate.Size() > current.Size())
+                {
+                    current = move(pr_candidate);
+                    RestoreClique(current.vertices);
+                    RebuildIndex();
+                    int ls_budget2 = max(10, n / 20);
+                    LocalSearch(ls_budget2);
+                }
+            }
+
+            // Shake / rebuild: perturb and re-search
+            PerturbeClique();
+            RebuildIndex();
+            int ls_budget3 = max(10, n / 20);
+            LocalSearch(ls_budget3);
+            current = CaptureCurrentClique();
+
+            // Insert into elite pool if good
+            if (current.Size() > 0)
+                elite.Offer(current);
+
+            // Update global best
+            owner->OfferBest(current, iter + 1);
+        }
+        owner = this;
+    }
+
+    // Tabu memory: moves made by LocalSearch so far and, per vertex, the move until which it
+    // may not change sides (never reset: old entries simply expire)
+    long long step = 0;
+    vector<long long> tabu_until;
+    vector<int> best_local;
+    // Scratch rows for the common neighbourhood (PathRelink, RunInitialHeuristic)
+    // and for AndRow on graphs without a matrix
+    vector<bits::Word> relink_common;
+    vector<bits::Word> csr_row;
+    function<void(const vector<int>&)> on_improvement;
     int q_border = 0;
     int c_border = 0;
 
@@ -354,7 +567,7 @@ private:
         int t = 0;
         for (int i = 0; i < q_border; ++i)
         {
-            if (non_neighbours[qco[i]].count(vertex))
+            if (qco[i] != vertex && !graph.HasEdge(qco[i], vertex))
                 ++t;
         }
         return t;
@@ -369,9 +582,53 @@ private:
         for (int i = 0; i < q_border; ++i)
         {
             int u = qco[i];
-            for (int v : non_neighbours[u])
+            ForEachNonNeighbour(u, [&](int v)
+            {
                 if (v >= 0 && v < n) tightness[v]++;
+            });
+        }
+    }
+
+    // RebuildBorders: regroup the non-clique part of `qco` so that the free
+    // vertices (tightness 0) come first and end at c_border. O(n), used after
+    // RebuildTightness; single moves keep the borders up to date themselves
+    void RebuildBorders()
+    {
+        int n = (int)qco.size();
+        c_border = q_border;
+        for (int i = q_border; i < n; ++i)
+        {
+            if (tightness[qco[i]] == 0)
+            {
+                SwapVertices(qco[i], c_border);
+                ++c_border;
+            }
+        }
+    }
+
+    // Debug mode (TABU_CHECK_TIGHTNESS): compares the incrementally kept tightness,
+    // index and borders with a full rebuild and aborts on the first mismatch
+    void CheckTightness(const char* where)
+    {
+#ifdef TABU_CHECK_TIGHTNESS
+        int n = (int)qco.size();
+        vector<int> expected(n, 0);
+        for (int i = 0; i < q_border; ++i)
+            ForEachNonNeighbour(qco[i], [&](int v) { expected[v]++; });
+        for (int i = 0; i < n; ++i)
+        {
+            int v = qco[i];
+            bool region_ok = i < c_border ? expected[v] == 0 : expected[v] > 0;
+            if (index[v] != i || tightness[v] != expected[v] || !region_ok)
+            {
+                cerr << "Tightness check failed after " << where << " at vertex " << v
+                     << " (position " << i << ", tightness " << tightness[v] << ", expected " << expected[v] << ")\n";
+                abort();
+            }
         }
+#else
+        (void)where;
+#endif
     }
 
     void SwapVertices(int vertex, int border)
@@ -396,51 +653,70 @@ private:
         index[qco[border]] = border;
     }
 
+    // Adds a free vertex (tightness 0, in the candidate region) to the clique.
+    // Only the non-neighbours of i change: their tightness grows by one and
+    // those that were free leave the candidate region, O(|non-neighbours of i|)
     void InsertToClique(int i)
     {
-        int n = (int)qco.size();
-        int old_q = q_border;
-        // for non-clique vertices, if they currently have zero conflicts, move them to candidate region
-        for (int j : non_neighbours[i])
+        SwapVertices(i, q_border);
+        ++q_border;
+        ForEachNonNeighbour(i, [&](int j)
         {
-            if (j < 0 || j >= n) continue;
-            if (index[j] >= 0 && index[j] >= old_q)
+            if (tightness[j]++ == 0 && index[j] >= q_border && index[j] < c_border)
             {
-                if (tightness[j] == 0)
-                {
-                    --c_border;
-                    SwapVertices(j, c_border);
-                }
+                --c_border;
+                SwapVertices(j, c_border);
             }
-        }
-        SwapVertices(i, old_q);
-        ++q_border;
-        // rebuild tightness to be safe
-        RebuildTightness();
+        });
+        CheckTightness("InsertToClique");
     }
 
+    // Removes k from the clique; k becomes the first candidate and the non-neighbours
+    // of k that lose their last conflict join the candidate region
     void RemoveFromClique(int k)
     {
-        int n = (int)qco.size();
-        int old_q = q_border;
-        for (int j : non_neighbours[k])
+        --q_border;
+        SwapVertices(k, q_border);
+        ForEachNonNeighbour(k, [&](int j)
         {
-            if (j < 0 || j >= n) continue;
-            if (index[j] >= 0 && index[j] >= old_q)
+            if (--tightness[j] == 0 && index[j] >= c_border)
             {
-                if (tightness[j] == 1)
-                {
-                    SwapVertices(j, c_border);
-                    c_border++;
-                }
+                SwapVertices(j, c_border);
+                ++c_border;
             }
+        });
+        CheckTightness("RemoveFromClique");
+    }
+
+    // dst &= N(v): the matrix row, or the row spelled out from the CSR lists
+    void AndRow(bits::Word* dst, int v)
+    {
+        int words = bits::Words(graph.Size());
+        if (graph.HasMatrix())
+        {
+            const bits::Word* row = graph.Row(v);
+            for (int w = 0; w < words; ++w) dst[w] &= row[w];
+            return;
         }
-        --q_border;
-        SwapVertices(k, q_border);
-        // rebuild tightness to be safe
-        RebuildTightness();
+        csr_row.assign(words, 0);
+        for (const int* u = graph.NeighboursBegin(v); u != graph.NeighboursEnd(v); ++u)
+            bits::Set(csr_row.data(), *u);
+        for (int w = 0; w < words; ++w) dst[w] &= csr_row[w];
+    }
+
+    bool IsTabu(int vertex) const
+    {
+        return tabu_until[vertex] > step;
     }
 
+    // Randomized tenure growing with the clique (a larger clique has more swap partners
+    // to cycle through); a vertex entering the clique is held for 0.6 of it
+    long long Tenure()
+    {
+        return 7 + GetRandom(0, q_border);
+    }
+
+    // Exchanges a non-tabu clique vertex for a non-tabu vertex whose only conflict it is
     bool Swap1To1()
     {
         if (q_border <= 0) return false;
@@ -451,17 +727,22 @@ private:
         for (int counter : order)
         {
             int vertex = qco[counter];
+            if (IsTabu(vertex)) continue;
             // collect non-neighbors and randomize their order
             vector<int> candidates;
-            for (int i : non_neighbours[vertex]) candidates.push_back(i);
+            ForEachNonNeighbour(vertex, [&](int i) { candidates.push_back(i); });
             if (candidates.empty()) continue;
             shuffle(candidates.begin(), candidates.end(), rng);
             for (int i : candidates)
             {
-                if (i >= 0 && i < (int)tightness.size() && tightness[i] == 1)
+                if (i >= 0 && i < (int)tightness.size() && tightness[i] == 1 && !IsTabu(i))
                 {
                     RemoveFromClique(vertex);
                     InsertToClique(i);
+                    ++step;
+                    long long tenure = Tenure();
+                    tabu_until[vertex] = step + tenure;
+                    tabu_until[i] = step + (long long)(0.6 * tenure);
                     return true;
                 }
             }
@@ -469,7 +750,29 @@ private:
         return false;
     }
 
-    bool Move()
+    // Removes a random clique vertex (a non-tabu one if there is any) when Swap1To1 finds no
+    // move: either no vertex outside conflicts with exactly one clique vertex, or every such
+    // swap is tabu. The dropped vertex may not come back for a tenure
+    void Drop()
+    {
+        if (q_border <= 0) return;
+        int pos = GetRandom(0, q_border - 1);
+        for (int k = 0; k < q_border; ++k)
+        {
+            if (!IsTabu(qco[(pos + k) % q_border]))
+            {
+                pos = (pos + k) % q_border;
+                break;
+            }
+        }
+        int vertex = qco[pos];
+        RemoveFromClique(vertex);
+        ++step;
+        tabu_until[vertex] = step + Tenure();
+    }
+
+    // Adds a free vertex; tabu ones only if the clique then beats `best` (aspiration)
+    bool Move(int best)
     {
         if (c_border == q_border) return false;
         if (q_border < 0 || q_border >= (int)qco.size()) return false;
@@ -485,67 +788,45 @@ private:
         {
             int vertex = qco[p];
             // pick vertices compatible (tightness==0)
-            if (vertex >= 0 && vertex < (int)tightness.size() && tightness[vertex] == 0)
+            if (vertex >= 0 && vertex < (int)tightness.size() && tightness[vertex] == 0
+                && (!IsTabu(vertex) || q_border + 1 > best))
             {
                 InsertToClique(vertex);
+                ++step;
                 return true;
             }
         }
         return false;
     }
 
-    void RunInitialHeuristic(int randomization)
+    // Greedy randomized construction on top of the clique in qco[0..q_border-1] (empty or
+    // perturbed): the candidates are the common neighbourhood of the clique as a bitset, each
+    // step adds a uniformly random candidate and ANDs its row in, O(n/64) per step instead of
+    // re-checking every candidate against the whole clique
+    void RunInitialHeuristic()
     {
-        auto &generator = rng;
-        vector<int> candidates(neighbour_sets.size());
-        for (size_t i = 0; i < neighbour_sets.size(); ++i)
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Construction);
+        int n = graph.Size();
+        int words = bits::Words(n);
+        vector<bits::Word>& candidates = relink_common;
+        candidates.assign(words, 0);
+        bits::Fill(candidates.data(), n);
+        for (int i = 0; i < q_border; ++i)
         {
-            candidates[i] = i;
+            bits::Reset(candidates.data(), qco[i]);
+            AndRow(candidates.data(), qco[i]);
         }
-        shuffle(candidates.begin(), candidates.end(), generator);
-        while (! candidates.empty())
+        for (int count = bits::Count(candidates.data(), words); count > 0; count = bits::Count(candidates.data(), words))
         {
-            int last = candidates.size() - 1;
-            int maxIdx;
-            if (randomization <= 0) maxIdx = last;
-            else maxIdx = min(randomization - 1, last);
-            int rnd = GetRandom(0, maxIdx);
-            int vertex = candidates[rnd];
-            // Check compatibility with current clique (all vertices in qco[0..q_border-1])
-            bool compatible = true;
-            for (int i = 0; i < q_border; ++i)
-            {
-                if (neighbour_sets[vertex].count(qco[i]) == 0) { compatible = false; break; }
-            }
-            if (!compatible)
-            {
-                // remove this candidate and continue
-                swap(candidates[rnd], candidates.back());
-                candidates.pop_back();
-                continue;
-            }
-            // accept vertex into the clique
+            int vertex = bits::Select(candidates.data(), words, GetRandom(0, count - 1));
+            // accept vertex into the clique; only its neighbours stay candidates
             SwapVertices(vertex, q_border);
             ++q_border;
-            // filter remaining candidates to those compatible with the whole clique
-            for (int c = 0; c < (int)candidates.size(); ++c)
-            {
-                int candidate = candidates[c];
-                bool ok = true;
-                for (int i = 0; i < q_border; ++i)
-                {
-                    if (neighbour_sets[candidate].count(qco[i]) == 0) { ok = false; break; }
-                }
-                if (!ok)
-                {
-                    swap(candidates[c], candidates.back());
-                    candidates.pop_back();
-                    --c;
-                }
-            }
-            shuffle(candidates.begin(), candidates.end(), generator);
+            bits::Reset(candidates.data(), vertex);
+            AndRow(candidates.data(), vertex);
         }
-        // ensure tightness cache matches constructed clique
+        // ensure tightness cache and borders match the constructed clique
         RebuildTightness();
+        RebuildBorders();
     }
 };
\ No newline at end of file
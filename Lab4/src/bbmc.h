@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "../../Common/bitset.h"
+#include "../../Common/graph.h"
+#include "../../Common/perf_counters.h"
+#include "incumbent.h"
+#include "search_stats.h"
+
+
+// Bit-parallel branch and bound (BBMC, San Segundo et al.; coloring as in MCS).
+// Candidate sets, color classes and neighbourhoods are 64-bit word bitsets over the
+// vertices renumbered by non-increasing degree, so cut2 becomes one AND of the candidate
+// set with a matrix row and greedy coloring removes a whole neighbourhood per word op.
+// The bound is read from (and improvements are published to) a shared Incumbent,
+// so cliques found by other threads prune this search as well.
+// The rows are a renumbered copy of the graph's own matrix, so only graphs that carry one
+// (see Graph::WantsMatrix) can be searched; BnBSolver runs MCQD on the others.
+class BBMCEngine {
+public:
+    static bool Supports(const Graph& graph) { return graph.HasMatrix(); }
+
+    explicit BBMCEngine(const Graph& graph) {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Preprocessing);
+        n = graph.Size();
+        words = bits::Words(n);
+
+        // Initial order: non-increasing degree, ties by id
+        order.resize(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return graph.Degree(a) > graph.Degree(b);
+        });
+        std::vector<int> position(n);
+        for (int i = 0; i < n; ++i) position[order[i]] = i;
+
+        // Adjacency rows in the new numbering, read from the graph's matrix rows
+        if (!Supports(graph)) throw std::invalid_argument("BBMC needs a graph with an adjacency matrix");
+        rows.assign((size_t)n * words, 0);
+        for (int i = 0; i < n; ++i) {
+            bits::Word* row = Row(i);
+            bits::ForEach(graph.Row(order[i]), words, [&](int u) { bits::Set(row, position[u]); });
+        }
+
+        levels.resize(n + 1);
+        uncolored.resize(words);
+        colorClass.resize(words);
+    }
+
+    // Runs the search; on return `best` holds a maximum clique (original ids)
+    void Run(Incumbent& best) {
+        incumbent = &best;
+        current.clear();
+        found.clear();
+        nodes = 0;
+        stopped = false;
+        stats.Reset(n + 1, stats.timing);
+        if (n == 0) return;
+
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Branching);
+        Level& root = GetLevel(0);
+        bits::Fill(root.P.data(), n);
+        root.size = n;
+        Expand(0);
+    }
+
+    long long GetNodes() const { return nodes; }
+
+    // Statistics of the last Run(); BBMC never re-sorts, and its cut2 is the AND of P with a row
+    const SearchStats& GetStats() const { return stats; }
+
+    void SetStatsTiming(bool enabled) { stats.timing = enabled; }
+
+    // Polled every 1024 nodes with the node count; once it returns true the search unwinds
+    // and Run() returns with the best clique found so far
+    void SetStopCheck(std::function<bool(long long)> check) {
+        stopCheck = std::move(check);
+    }
+
+private:
+    struct Level {
+        std::vector<bits::Word> P;   // candidate set
+        std::vector<int> vertex;     // branching vertices in coloring order
+        std::vector<int> color;      // their color numbers (non-decreasing)
+        int size = 0;                // |P| when the level was entered
+    };
+
+    int n = 0;
+    int words = 0;
+    std::vector<int> order;              // new index -> original id
+    std::vector<bits::Word> rows;
+    std::vector<Level> levels;
+    std::vector<bits::Word> uncolored;   // scratch for the coloring
+    std::vector<bits::Word> colorClass;
+    std::vector<int> current;            // clique in new indices
+    std::vector<int> found;              // scratch for publishing in original ids
+    Incumbent* incumbent = nullptr;
+    long long nodes = 0;
+    std::function<bool(long long)> stopCheck;
+    bool stopped = false;
+    SearchStats stats;
+
+    bits::Word* Row(int v) {
+        return rows.data() + (size_t)v * words;
+    }
+
+    // Per-depth buffers are allocated once on first use and reused afterwards
+    Level& GetLevel(int depth) {
+        Level& level = levels[depth];
+        if (level.P.empty()) {
+            level.P.resize(words);
+            level.vertex.resize(n);
+            level.color.resize(n);
+        }
+        return level;
+    }
+
+    // Greedy sequential coloring of P by color classes (independent sets built with word ops).
+    // Only vertices whose color can still improve the incumbent (k >= kmin) are returned for branching.
+    int ColorSort(Level& level) {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Coloring);
+        int kmin = incumbent->Size() - (int)current.size() + 1;
+        int m = 0;
+        int k = 0;
+        std::copy(level.P.begin(), level.P.end(), uncolored.begin());
+        int first = 0;
+        while (true) {
+            while (first < words && uncolored[first] == 0) ++first;
+            if (first == words) break;
+            ++k;
+            std::copy(uncolored.begin() + first, uncolored.end(), colorClass.begin() + first);
+            for (int w = first; w < words; ++w) {
+                while (colorClass[w]) {
+                    int v = w * 64 + std::countr_zero(colorClass[w]);
+                    // v joins color k: leaves the uncolored set, its neighbours leave the class
+                    bits::Reset(uncolored.data(), v);
+                    bits::Reset(colorClass.data(), v);
+                    const bits::Word* row = Row(v);
+                    for (int x = w; x < words; ++x) colorClass[x] &= ~row[x];
+                    if (k >= kmin) {
+                        level.vertex[m] = v;
+                        level.color[m] = k;
+                        ++m;
+                    }
+                }
+            }
+        }
+        return m;
+    }
+
+    void Expand(int depth) {
+        if (++nodes % 1024 == 0 && stopCheck && stopCheck(nodes)) stopped = true;
+        ++stats.nodesPerDepth[depth + 1];
+        if (stopped) return;
+        Level& level = GetLevel(depth);
+        auto start = stats.Start();
+        int m = ColorSort(level);
+        stats.Stop(stats.colorSortSeconds, start);
+        // Candidates left out by ColorSort are cut by the bound as well (MCQD meets them in R)
+        int pruned = level.size - m;
+
+        for (int i = m - 1; i >= 0 && !stopped; --i) {
+            // Bound: the coloring of the remaining candidates uses at most color[i] colors
+            if ((int)current.size() + level.color[i] <= incumbent->Size()) {
+                pruned += i + 1;
+                break;
+            }
+
+            int v = level.vertex[i];
+            current.push_back(v);
+
+            Level& next = GetLevel(depth + 1);
+            const bits::Word* row = Row(v);
+            int size = 0;
+            start = stats.Start();
+            for (int w = 0; w < words; ++w) {
+                next.P[w] = level.P[w] & row[w];
+                size += std::popcount(next.P[w]);
+            }
+            stats.Stop(stats.cut2Seconds, start);
+            next.size = size;
+            ++stats.children;
+            stats.childCandidates += size;
+
+            if (size > 0) {
+                Expand(depth + 1);
+            } else {
+                ++stats.leaves;
+                if ((int)current.size() > incumbent->Size()) {
+                    found.clear();
+                    for (int u : current) found.push_back(order[u]);
+                    incumbent->Offer(found);
+                }
+            }
+
+            current.pop_back();
+            bits::Reset(level.P.data(), v);
+        }
+        if (pruned > 0 && !stopped) {
+            ++stats.boundPrunes;
+            stats.prunedBranches += pruned;
+        }
+    }
+};
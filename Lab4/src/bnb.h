@@ -0,0 +1,689 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <time.h>
+#include <random>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include "../../Common/alloc_counter.h"
+#include "../../Common/bitset.h"
+#include "../../Common/graph_cache.h"
+#include "../../Common/perf_counters.h"
+#include "../../Common/solver.h"
+#include "../../Lab3/src/tabu.h"
+#include "bbmc.h"
+#include "incumbent.h"
+#include "search_stats.h"
+#include "work_stealing.h"
+using namespace std;
+
+
+// Реализованный здесь алгоритм это попытка миплементации алгоритма MQCD из статьи Konc/Janezic
+// https://gitlab.com/janezkonc/mcqd/-/tree/master  оригинальная реализация на C
+// Anytime controls (Common/solver.h): the iteration unit is a search node; a run cut short by
+// the budget or by Cancel() returns the best clique found so far without proving it maximum.
+class BnBSolver : public AnytimeSolver {
+public:
+    // MCQD: recursion over Vertex lists below; BBMC: bit-parallel engine from bbmc.h
+    // (graphs without a bitset matrix are searched by MCQD either way)
+    enum class Engine { MCQD, BBMC };
+
+    // Upper bound used by the MCQD coloring: plain greedy coloring, or coloring tightened
+    // by MaxSAT reasoning over the color classes (see absorbInconsistent)
+    enum class Bound { Coloring, MaxSat };
+
+    void ReadGraphFile(const std::string& filename) {
+        {
+            perf_counters::ScopedPhase phase(perf_counters::Phase::Load);
+            // Общий загрузчик DIMACS (Common/graph_cache.h)
+            graph = LoadGraph(filename);
+        }
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Preprocessing);
+        int n = graph.Size();
+        vertices.clear();
+        for (int i = 0; i < n; ++i) vertices.push_back({i, 0});
+
+        ClearAll();
+    }
+
+    void SetEngine(Engine e) { engine = e; }
+
+    // Engine of the last RunBnB: the one set, unless BBMC fell back to MCQD (no bitset matrix)
+    Engine GetEngineUsed() const { return engineUsed; }
+
+    // Number of worker threads for the MCQD search (1 = sequential recursion)
+    void SetThreads(int t) { threads = std::max(1, t); }
+
+    void SetBound(Bound b) { bound = b; }
+
+    // Number of tabu search threads (Lab3) running alongside the exact search and
+    // publishing their cliques into the shared incumbent; 0 = exact search only.
+    // They are stopped as soon as the exact search finishes, i.e. proves optimality.
+    void SetPortfolio(int heuristics) { portfolioThreads = std::max(0, heuristics); }
+
+    // Base seed of the portfolio searches (search i uses seed + i); the exact search is deterministic
+    void Seed(unsigned seed) { portfolioSeed = seed; }
+
+    // Also time color_sort, cut2 and the dynamic re-sort in GetStats() (two clock reads per call)
+    void SetStatsTiming(bool enabled) { statsTiming = enabled; }
+
+    // MCQD re-sorts a child by degree while the share of nodes at its level stays below Tlimit
+    void SetTlimit(float limit) { Tlimit = limit; }
+
+    void RunBnB()
+    {
+        // Best clique, shared by all workers
+        Qmax.clear();
+        incumbent.Reset();
+        incumbent.SetCallback([this](const std::vector<int>& clique) {
+            if (logFile) {
+                (*logFile) << "New best: " << clique.size()
+                        << "; time: " << GetElapsedSeconds() << '\n';
+            }
+            Report(clique.size(), -1, sharedNodes.load(std::memory_order_relaxed));
+        });
+
+        StartRun();
+        stopSearch.store(false);
+        sharedNodes.store(0);
+
+        if (logFile) {
+            (*logFile) << graphName << '\n';
+        }
+
+        // BBMC needs the bitset matrix, which large sparse graphs are loaded without
+        engineUsed = engine == Engine::BBMC && BBMCEngine::Supports(graph) ? Engine::BBMC : Engine::MCQD;
+        if (engineUsed == Engine::BBMC) {
+            RunBBMC();
+            return;
+        }
+
+        // One search context per worker
+        int n = vertices.size();
+        contexts.assign(threads, SearchContext());
+        for (int w = 0; w < threads; ++w) ResetContext(contexts[w], w, n);
+
+        // Heuristics improve the lower bound in the background (see SetPortfolio)
+        StartPortfolio();
+
+        // initial setup
+        {
+            perf_counters::ScopedPhase phase(perf_counters::Phase::Preprocessing);
+            // At the root every vertex is a candidate, so the degrees are the graph's own
+            for (auto &v : vertices) v.degree = graph.Degree(v.id);
+            sortByDegree(vertices);
+            initColors(vertices);
+        }
+
+        // Starting the BnB; after this point the sequential search does not touch the heap
+        incumbent.Reserve(n);
+        long long allocationsBefore = alloc_counter::Take().allocations;
+        if (threads == 1) {
+            perf_counters::ScopedPhase phase(perf_counters::Phase::Branching);
+            SearchContext& ctx = contexts[0];
+            ctx.frames[1].assign(vertices.begin(), vertices.end());
+            BnBrecursion(ctx, ctx.frames[1], 0);
+        } else {
+            RunParallel();
+        }
+        searchAllocations = alloc_counter::Take().allocations - allocationsBefore;
+        StopPortfolio();
+
+        searchNodes = 0;
+        stats.Reset(0, statsTiming);
+        for (const SearchContext& ctx : contexts) {
+            searchNodes += ctx.nodes;
+            stats.Merge(ctx.stats);
+        }
+
+        FinishRun();
+    }
+
+    const std::vector<int>& GetClique() const { return Qmax; }
+
+    // Search tree nodes visited by the last search (all workers together)
+    long long GetNodes() const { return searchNodes; }
+
+    // Search-tree statistics of the last search (all workers together)
+    const SearchStats& GetStats() const { return stats; }
+
+    // Heap allocations made by the last MCQD search, heuristic threads included
+    // (-1 if the counter is not installed)
+    long long GetSearchAllocations() const {
+        return alloc_counter::Installed() ? searchAllocations : -1;
+    }
+
+    bool Check() const {
+        for (size_t i = 0; i < Qmax.size(); ++i)
+            for (size_t j = i + 1; j < Qmax.size(); ++j)
+                if (!graph.HasEdge(Qmax[i], Qmax[j])) return false;
+        return true;
+    }
+
+    // Forgets the best clique and the search state of the last run (the graph is kept)
+    void ClearAll() {
+        Qmax.clear();
+        incumbent.Reset();
+        contexts.clear();
+    }
+
+    void SetLogger(std::ofstream& out, const std::string& name)
+    {
+        logFile = &out;
+        graphName = name;
+    }
+
+private:
+
+    void StartPortfolio()
+    {
+        stopHeuristics.store(false);
+        for (int i = 0; i < portfolioThreads; ++i) {
+            heuristics.emplace_back([this, i] {
+                MaxCliqueTabuSearch heuristic;
+                heuristic.SetGraph(graph);
+                heuristic.Seed(portfolioSeed + i);
+                heuristic.SetTimeLimit(std::numeric_limits<double>::infinity());
+                heuristic.SetCancelFlag(&stopHeuristics);
+                heuristic.SetImprovementCallback([this](const std::vector<int>& clique) {
+                    incumbent.Offer(clique);
+                });
+                heuristic.RunSearch(std::numeric_limits<int>::max());
+            });
+        }
+    }
+
+    void StopPortfolio()
+    {
+        stopHeuristics.store(true);
+        for (auto& t : heuristics) t.join();
+        heuristics.clear();
+    }
+
+    void RunBBMC()
+    {
+        BBMCEngine bbmc(graph);
+        bbmc.SetStatsTiming(statsTiming);
+        StartPortfolio();
+        bbmc.SetStopCheck([this](long long nodes) {
+            sharedNodes.store(nodes, std::memory_order_relaxed);
+            return ShouldStop(nodes);
+        });
+        bbmc.Run(incumbent);
+        StopPortfolio();
+        searchNodes = bbmc.GetNodes();
+        stats = bbmc.GetStats();
+        FinishRun();
+    }
+
+    // A completed search proves the incumbent maximum, so the bound meets the best value
+    void FinishRun()
+    {
+        Qmax = incumbent.Get();
+        Report(Qmax.size(), WasInterrupted() ? -1 : (long long)Qmax.size(), searchNodes);
+
+        if (logFile) {
+            (*logFile) << (WasInterrupted() ? "INTERRUPTED" : "FINISHED")
+                       << " - Clique size: " << Qmax.size()
+                       << "; time: " << GetElapsedSeconds() << '\n';
+        }
+    }
+
+    Engine engine = Engine::MCQD;
+    Engine engineUsed = Engine::MCQD;
+    Bound bound = Bound::Coloring;
+    Graph graph;
+    std::ofstream* logFile = nullptr; 
+    std::string graphName;              
+
+    // Vertex structure for convenience
+    struct Vertex {
+        int id;
+        int degree;
+    };
+
+    // for dynamic coloring if needed
+    struct StepCount {
+        int i1 = 0;
+        int i2 = 0;
+        void inc() { ++i1; }
+    };
+
+    // State of one MCQD search (the sequential search uses a single context).
+    // Every buffer is sized once in ResetContext: frames[level] holds the candidate list R
+    // of that depth, color classes are singly linked lists over colorScratch positions.
+    // The MaxSAT marks (satAbsorbed, satUsed, satTouched) hold the satNode (per coloring) or
+    // satTest (per propagation) stamp they were set under, so they never need clearing.
+    struct SearchContext {
+        std::vector<int> Q;
+        std::vector<std::vector<Vertex>> frames;
+        std::vector<Vertex> colorScratch;
+        std::vector<int> colorHead, colorTail, colorNext;
+        std::vector<StepCount> S;
+        std::vector<bits::Word> satClass;    // classes 1..K as bitsets over vertex ids
+        std::vector<bits::Word> satAlive;    // vertices not yet false (propagation, failed literal)
+        std::vector<long long> satAbsorbed;  // position: moved out of the branching part
+        std::vector<long long> satUsed;      // class: in an inconsistent subset of this node
+        std::vector<long long> satTouched;   // class: unit or empty in the current propagation
+        long long satNode = 0;
+        long long satTest = 0;
+        std::vector<long long> cutMark;      // vertex: neighbour of the cut2 vertex (graphs without a matrix)
+        long long cutStamp = 0;
+        long long nodes = 0;
+        int level = 1;
+        int pk = 0;
+        int worker = 0;
+        SearchStats stats;
+    };
+
+    // Subproblem for the parallel search: branches on R[stop..] (from the back) under clique Q.
+    // Root branches share one candidate list, deeper splits copy their prefix of R.
+    // `resumed` marks a node already counted by the worker that expanded it first.
+    struct BranchTask {
+        std::vector<int> Q;
+        std::shared_ptr<const std::vector<Vertex>> R;
+        int size = 0;
+        int stop = 0;
+        bool resumed = false;
+    };
+
+    std::vector<Vertex> vertices;
+    std::vector<int> Qmax;
+    Incumbent incumbent;
+    std::vector<SearchContext> contexts;
+    int threads = 1;
+    int portfolioThreads = 0;
+    unsigned portfolioSeed = 123456;
+    std::vector<std::thread> heuristics;
+    std::atomic<bool> stopHeuristics{false};
+    long long searchAllocations = 0;
+    long long searchNodes = 0;
+    SearchStats stats;
+    bool statsTiming = false;
+    // Nodes of all workers in steps of kCheckInterval, and the flag that unwinds them
+    // once ShouldStop() fires
+    static constexpr long long kCheckInterval = 1024;
+    std::atomic<long long> sharedNodes{0};
+    std::atomic<bool> stopSearch{false};
+    WorkStealingPool<BranchTask>* pool = nullptr;
+    // Nodes at depth <= splitDepth may hand half of their branches to idle workers
+    const int splitDepth = 8;
+    float Tlimit = 0.025f;
+
+    void ResetContext(SearchContext& ctx, int worker, int n) {
+        // Below the root R is a neighbourhood, so neither its size nor the depth exceeds max degree + 1
+        int maxDegree = 0;
+        for (int v = 0; v < n; ++v) maxDegree = std::max(maxDegree, graph.Degree(v));
+        int depth = std::min(n, maxDegree + 1) + 2;
+
+        ctx.Q.clear();
+        ctx.Q.reserve(n);
+        ctx.frames.assign(depth + 1, std::vector<Vertex>());
+        for (int l = 1; l <= depth; ++l) ctx.frames[l].reserve(l == 1 ? n : maxDegree);
+        ctx.colorScratch.reserve(n);
+        ctx.colorHead.assign(n + 2, -1);
+        ctx.colorTail.assign(n + 2, -1);
+        ctx.colorNext.assign(n + 1, -1);
+        ctx.S.assign(depth + 1, StepCount());
+        if (useMaxSat()) {
+            ctx.satClass.assign((size_t)(n + 2) * graph.RowWords(), 0);
+            ctx.satAlive.assign(2 * graph.RowWords(), 0);
+        }
+        ctx.satAbsorbed.assign(n + 1, 0);
+        ctx.satUsed.assign(n + 2, 0);
+        ctx.satTouched.assign(n + 2, 0);
+        ctx.satNode = 0;
+        ctx.satTest = 0;
+        if (!graph.HasMatrix()) ctx.cutMark.assign(n, 0);
+        ctx.cutStamp = 0;
+        ctx.nodes = 0;
+        ctx.level = 1;
+        ctx.pk = 0;
+        ctx.worker = worker;
+        ctx.stats.Reset(depth, statsTiming);
+    }
+
+    // The graph's bitset row when it has one, a search of the sorted neighbour list otherwise
+    bool connection(int i, int j) const {
+        return graph.HasEdge(i, j);
+    }
+
+    // counting the degrees of vertices
+    void setDegrees(std::vector<Vertex>& R) {
+        for (auto &v : R) {
+            int d = 0;
+            for (auto &u : R)
+                if (connection(v.id, u.id)) ++d;
+            v.degree = d;
+        }
+    }
+
+    // sorting by degrees in descending order
+    void sortByDegree(std::vector<Vertex>& R) {
+        std::sort(R.begin(), R.end(), [](const Vertex &a, const Vertex &b) {
+            return a.degree > b.degree;
+        });
+    }
+
+    // Starting initial upper bound by coloring
+    void initColors(std::vector<Vertex>& R) {
+        int max_degree = 0;
+        for (auto &v : R) if (v.degree > max_degree) max_degree = v.degree;
+        for (size_t i = 0; i < R.size(); ++i) {
+            if (i < (size_t)max_degree) R[i].degree = i + 1;
+            else R[i].degree = max_degree + 1;
+        }
+    }
+
+    // Checking if vertex v can be added to color class k
+    bool cut1(const SearchContext &ctx, const Vertex &v, int k) const {
+        for (int p = ctx.colorHead[k]; p != -1; p = ctx.colorNext[p])
+            if (connection(v.id, ctx.colorScratch[p].id)) return true;
+        return false;
+    }
+
+    //Filtering vertices connected to the clique; without the matrix the neighbours of the
+    //new vertex are marked first, so every candidate costs one lookup instead of a search
+    void cut2(SearchContext &ctx, const std::vector<Vertex> &A, std::vector<Vertex> &B) const {
+        B.clear();
+        const Vertex &last = A.back();
+        if (graph.HasMatrix()) {
+            for (size_t i = 0; i < A.size() - 1; ++i)
+                if (connection(last.id, A[i].id)) B.push_back(A[i]);
+            return;
+        }
+        long long stamp = ++ctx.cutStamp;
+        for (const int* u = graph.NeighboursBegin(last.id); u != graph.NeighboursEnd(last.id); ++u)
+            ctx.cutMark[*u] = stamp;
+        for (size_t i = 0; i < A.size() - 1; ++i)
+            if (ctx.cutMark[A[i].id] == stamp) B.push_back(A[i]);
+    }
+
+    // Greedy coloring + sorting for branch upper bound
+    void color_sort(SearchContext &ctx, std::vector<Vertex> &R) {
+        perf_counters::ScopedPhase phase(perf_counters::Phase::Coloring);
+        auto &scratch = ctx.colorScratch;
+        auto &head = ctx.colorHead;
+        auto &tail = ctx.colorTail;
+        auto &next = ctx.colorNext;
+        int j = 0;
+        int maxno = 0;
+        int min_k = incumbent.Size() - (int)ctx.Q.size() + 1;
+        scratch.assign(R.begin(), R.end());
+
+        for (int i = 0; i < (int)scratch.size(); ++i) {
+            const Vertex &v = scratch[i];
+            int k = 1;
+            while (k <= maxno && cut1(ctx, v, k)) k++;
+            if (k > maxno) {
+                maxno = k;
+                head[k] = -1;
+            }
+            // appending position i to class k
+            next[i] = -1;
+            if (head[k] == -1) head[k] = i;
+            else next[tail[k]] = i;
+            tail[k] = i;
+            if (k < min_k) R[j++] = v;
+        }
+
+        if (min_k <= 0) min_k = 1;
+
+        // Vertices proven not to raise the bound join the non-branching part
+        bool absorbing = useMaxSat() && min_k > 1 && maxno >= min_k;
+        if (absorbing) {
+            int before = j;
+            j = absorbInconsistent(ctx, R, j, min_k, maxno);
+            ctx.stats.maxSatAbsorbed += j - before;
+        }
+
+        if (j > 0) R[j-1].degree = 0;
+
+        for (int k = min_k; k <= maxno; ++k)
+            for (int p = head[k]; p != -1; p = next[p]) {
+                if (absorbing && ctx.satAbsorbed[p] == ctx.satNode) continue;
+                R[j] = scratch[p];
+                R[j++].degree = k;
+            }
+    }
+
+    // MaxSAT reasoning over the color classes (Li & Quan, MaxCLQ / IncMaxCLQ).
+    // Every class C_1..C_K below min_k (K = min_k - 1) is a soft clause "some vertex of C_c is in
+    // the clique", and at most K of them can hold, which is the bound for the non-branching part.
+    // A branching vertex v adds a unit clause {v}; if propagation from v empties a class,
+    // {v} with the classes it went through is an inconsistent subset, so the K + 1 clauses still
+    // admit at most K true ones and v joins the non-branching part without raising the bound.
+    // Subsets found at one node must be disjoint, so their classes are consumed.
+    // Absorbed vertices are appended to R[0..j) and marked in satAbsorbed.
+    int absorbInconsistent(SearchContext &ctx, std::vector<Vertex> &R, int j, int min_k, int maxno) {
+        int K = min_k - 1;
+        int words = graph.RowWords();
+        long long node = ++ctx.satNode;
+
+        // Classes as bitsets over the vertex ids, so propagation works on matrix rows
+        for (int c = 1; c <= K; ++c) {
+            bits::Word* cls = satClass(ctx, c);
+            bits::Clear(cls, words);
+            for (int p = ctx.colorHead[c]; p != -1; p = ctx.colorNext[p])
+                bits::Set(cls, ctx.colorScratch[p].id);
+        }
+
+        int freeClasses = K;
+        for (int k = min_k; k <= maxno && freeClasses > 0; ++k)
+            for (int p = ctx.colorHead[k]; p != -1 && freeClasses > 0; p = ctx.colorNext[p]) {
+                int used = propagate(ctx, ctx.colorScratch[p].id, K);
+                if (used == 0) continue;
+                freeClasses -= used;
+                R[j++] = ctx.colorScratch[p];
+                ctx.satAbsorbed[p] = node;
+            }
+        return j;
+    }
+
+    // Propagation runs on the bitset matrix rows; graphs loaded without them keep the coloring bound
+    bool useMaxSat() const {
+        return bound == Bound::MaxSat && graph.HasMatrix();
+    }
+
+    bits::Word* satClass(SearchContext &ctx, int c) const {
+        return ctx.satClass.data() + (size_t)c * graph.RowWords();
+    }
+
+    // Propagation from vertex v over the unused classes 1..K: unit propagation, then a failed
+    // literal test on the smallest remaining class (every vertex of it leads to a conflict).
+    // Returns the number of classes consumed by the inconsistent subset found, 0 if there is none.
+    int propagate(SearchContext &ctx, int v, int K) {
+        const int kFailedLiteralMax = 3;
+        int words = graph.RowWords();
+        bits::Word* alive = ctx.satAlive.data();
+        bits::Word* branch = alive + words;
+        long long node = ctx.satNode;
+        long long test = ++ctx.satTest;
+
+        // v is true: its non-neighbours are false
+        std::copy(graph.Row(v), graph.Row(v) + words, alive);
+        bool conflict = unitPropagate(ctx, alive, K, test, test);
+
+        if (!conflict) {
+            int literalClass = -1;
+            int literalCount = kFailedLiteralMax + 1;
+            for (int c = 1; c <= K; ++c) {
+                if (ctx.satUsed[c] == node || ctx.satTouched[c] == test) continue;
+                const bits::Word* cls = satClass(ctx, c);
+                int count = 0;
+                for (int w = 0; w < words; ++w) count += std::popcount(cls[w] & alive[w]);
+                if (count < literalCount) {
+                    literalClass = c;
+                    literalCount = count;
+                }
+            }
+            if (literalClass != -1) {
+                const bits::Word* cls = satClass(ctx, literalClass);
+                ctx.satTouched[literalClass] = test;
+                conflict = true;
+                for (int w = 0; w < words && conflict; ++w)
+                    for (bits::Word m = cls[w] & alive[w]; m && conflict; m &= m - 1) {
+                        const bits::Word* row = graph.Row(w * 64 + std::countr_zero(m));
+                        for (int x = 0; x < words; ++x) branch[x] = alive[x] & row[x];
+                        conflict = unitPropagate(ctx, branch, K, test, ++ctx.satTest);
+                    }
+            }
+        }
+        if (!conflict) return 0;
+
+        // Consuming every class that took part in the propagation (a superset of the
+        // inconsistent subset proper, which is still inconsistent)
+        int consumed = 0;
+        for (int c = 1; c <= K; ++c)
+            if (ctx.satTouched[c] >= test && ctx.satUsed[c] != node) {
+                ctx.satUsed[c] = node;
+                ++consumed;
+            }
+        return consumed;
+    }
+
+    // Unit propagation on `alive` (vertices not yet false). Classes marked with `base` are
+    // already decided; classes that become unit or empty here are marked with `stamp`.
+    // Returns true on a conflict (an empty class).
+    bool unitPropagate(SearchContext &ctx, bits::Word* alive, int K, long long base, long long stamp) {
+        int words = graph.RowWords();
+        long long node = ctx.satNode;
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (int c = 1; c <= K; ++c) {
+                if (ctx.satUsed[c] == node || ctx.satTouched[c] == base || ctx.satTouched[c] == stamp) continue;
+                const bits::Word* cls = satClass(ctx, c);
+                int count = 0;
+                int unit = -1;
+                for (int w = 0; w < words && count < 2; ++w) {
+                    bits::Word m = cls[w] & alive[w];
+                    if (m) {
+                        count += std::popcount(m);
+                        unit = w * 64 + std::countr_zero(m);
+                    }
+                }
+                if (count >= 2) continue;
+                ctx.satTouched[c] = stamp;
+                if (count == 0) return true;
+                // the single vertex left is true as well
+                const bits::Word* row = graph.Row(unit);
+                for (int w = 0; w < words; ++w) alive[w] &= row[w];
+                progress = true;
+            }
+        }
+        return false;
+    }
+
+    // Root branches go round-robin into the workers' deques, deeper levels are split on demand
+    void RunParallel()
+    {
+        WorkStealingPool<BranchTask> workPool(threads);
+        pool = &workPool;
+
+        auto root = std::make_shared<const std::vector<Vertex>>(vertices);
+        // The root is one node, counted by the task of its first branch only
+        for (int i = 0; i < (int)vertices.size(); ++i)
+            workPool.Push(i % threads, BranchTask{{}, root, i + 1, i, i > 0});
+
+        workPool.Run([this](int worker, BranchTask& task) {
+            perf_counters::ScopedPhase phase(perf_counters::Phase::Branching);
+            SearchContext& ctx = contexts[worker];
+            ctx.Q = task.Q;
+            ctx.level = (int)ctx.Q.size() + 1;
+            std::vector<Vertex>& R = ctx.frames[ctx.level];
+            R.assign(task.R->begin(), task.R->begin() + task.size);
+            BnBrecursion(ctx, R, task.stop, task.resumed);
+        });
+        pool = nullptr;
+    }
+
+    // The main BnB recursion function: branches on R.back() down to R[stop].
+    // R is ctx.frames[level], the children are built in ctx.frames[level + 1].
+    // A resumed node (the branches a split handed over) is not counted again.
+    void BnBrecursion(SearchContext &ctx, std::vector<Vertex> &R, int stop, bool resumed = false)
+    {
+        auto &S = ctx.S;
+        auto &Q = ctx.Q;
+        int &level = ctx.level;
+        auto &stats = ctx.stats;
+        if (!resumed) {
+            ++ctx.nodes;
+            ++stats.nodesPerDepth[level];
+
+            // Budget and cancellation are checked every kCheckInterval nodes of this worker
+            if (ctx.nodes % kCheckInterval == 0 &&
+                ShouldStop(sharedNodes.fetch_add(kCheckInterval, std::memory_order_relaxed) + kCheckInterval))
+                stopSearch.store(true, std::memory_order_relaxed);
+        }
+        if (stopSearch.load(std::memory_order_relaxed)) return;
+
+        // Updating the depth statistic
+        S[level].i1 += S[level-1].i1 - S[level].i2;
+        S[level].i2 = S[level-1].i1;
+
+        while ((int)R.size() > stop && !stopSearch.load(std::memory_order_relaxed)) {
+            // Handing the lower half of the remaining branches to an idle worker
+            if (pool && level <= splitDepth && (int)R.size() - stop >= 2 && pool->HasIdle()) {
+                int mid = stop + ((int)R.size() - stop) / 2;
+                auto prefix = std::make_shared<const std::vector<Vertex>>(R.begin(), R.begin() + mid);
+                pool->Push(ctx.worker, BranchTask{Q, prefix, mid, stop, true});
+                stop = mid;
+            }
+
+            Vertex v = R.back();
+
+            // UB check
+            if ((int)Q.size() + v.degree > incumbent.Size()) {
+                Q.push_back(v.id);
+
+                std::vector<Vertex> &Rp = ctx.frames[level + 1];
+                auto start = stats.Start();
+                cut2(ctx, R, Rp);
+                stats.Stop(stats.cut2Seconds, start);
+                ++stats.children;
+                stats.childCandidates += Rp.size();
+
+                if (!Rp.empty()) {
+
+                    // Dynamic coloring condition
+                    ++stats.resortChecks;
+                    if ((float)S[level].i1 / ++ctx.pk < Tlimit) {
+                        ++stats.resorts;
+                        start = stats.Start();
+                        setDegrees(Rp);
+                        sortByDegree(Rp);
+                        stats.Stop(stats.resortSeconds, start);
+                    }
+                    start = stats.Start();
+                    color_sort(ctx, Rp);
+                    stats.Stop(stats.colorSortSeconds, start);
+                    S[level].inc();
+                    level++;
+                    BnBrecursion(ctx, Rp, 0);
+                    level--;
+
+                // Found a leaf, check if better than best known
+                } else {
+                    ++stats.leaves;
+                    if ((int)Q.size() > incumbent.Size()) incumbent.Offer(Q);
+                }
+                Q.pop_back();
+                R.pop_back();
+
+            // if not, nothing to search, go back
+            } else {
+                ++stats.boundPrunes;
+                stats.prunedBranches += (int)R.size() - stop;
+                return;
+            }
+        }
+    }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+// Best clique shared between search threads.
+// The size is an atomic so every node can prune against it without locking;
+// the clique itself is replaced under a mutex only when it actually improves.
+class Incumbent {
+public:
+    using ImproveCallback = std::function<void(const std::vector<int>&)>;
+
+    void Reset(const std::vector<int>& initial = {}) {
+        std::lock_guard<std::mutex> lock(mutex);
+        clique = initial;
+        size.store((int)clique.size(), std::memory_order_release);
+    }
+
+    // Preallocates the clique so that publishing a new best does not allocate
+    void Reserve(int n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        clique.reserve(n);
+    }
+
+    // Called under the lock with every new best clique
+    void SetCallback(ImproveCallback callback) {
+        std::lock_guard<std::mutex> lock(mutex);
+        onImprove = std::move(callback);
+    }
+
+    int Size() const {
+        return size.load(std::memory_order_relaxed);
+    }
+
+    // Publishes `candidate` if it is larger than the current best; returns true if it was taken
+    bool Offer(const std::vector<int>& candidate) {
+        if ((int)candidate.size() <= Size()) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        if ((int)candidate.size() <= (int)clique.size()) return false;
+        clique = candidate;
+        size.store((int)clique.size(), std::memory_order_release);
+        if (onImprove) onImprove(clique);
+        return true;
+    }
+
+    std::vector<int> Get() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return clique;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<int> clique;
+    std::atomic<int> size{0};
+    ImproveCallback onImprove;
+};
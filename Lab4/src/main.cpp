@@ -1,302 +1,28 @@
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <vector>
-#include <sstream>
-#include <time.h>
-#include <random>
-#include <unordered_set>
-#include <unordered_map>
-#include <algorithm>
-#include "../../Lab3/src/tabu.h"
-using namespace std;
+#include "../../Common/alloc_counter.h"
+#include "bnb.h"
 
+// Counting heap allocations so the search can prove it runs allocation-free
+ALLOC_COUNTER_INSTALL()
 
-// Реализованный здесь алгоритм это попытка миплементации алгоритма MQCD из статьи Konc/Janezic
-// https://gitlab.com/janezkonc/mcqd/-/tree/master  оригинальная реализация на C
-class BnBSolver {
-public:
-    void ReadGraphFile(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file) throw std::runtime_error("Cannot open file");
 
-        std::string line;
-        int n = 0;
-
-        // Чтение header p edge n m
-        while (std::getline(file, line)) {
-            if (line.empty() || line[0] == 'c') continue;
-            if (line[0] == 'p') {
-                std::istringstream iss(line);
-                std::string tmp;
-                int m;
-                iss >> tmp >> tmp >> n >> m;
-                adjMatrix.assign(n, std::vector<bool>(n, false));
-                break;
-            }
-        }
-
-        // Чтение рёбер
-        while (std::getline(file, line)) {
-            if (line.empty() || line[0] == 'c') continue;
-            std::istringstream iss(line);
-            char t;
-            int u, v;
-            iss >> t >> u >> v;
-            if (t == 'e') {
-                adjMatrix[u - 1][v - 1] = true;
-                adjMatrix[v - 1][u - 1] = true;
-            }
-        }
-
-        vertices.clear();
-        for (int i = 0; i < n; ++i) vertices.push_back({i, 0});
-
-        ClearAll();
-    }
-
-    void RunBnB()
-    {
-        // Current and best cliques
-        Q.clear();
-        Qmax.clear();
-
-        startTime = clock();
-
-        if (logFile) {
-            (*logFile) << graphName << '\n';
-        }
-
-
-        // Color classes step count
-        int n = vertices.size();
-        C.assign(n + 1, std::vector<Vertex>());
-        S.assign(n + 1, StepCount());
-        for (auto &s : S) { s.i1 = 0; s.i2 = 0; }
-
-        //depth
-        level = 1;
-        pk = 0;
-
-        /*
-        // Running initial heuristic to get a good lower bound
-        MaxCliqueTabuSearch heuristic;
-        vector<unordered_set<int>> neighbour_sets(n);
-        for (int i = 0; i < n; ++i)
-            for (int j = 0; j < n; ++j)
-                if (adjMatrix[i][j]) neighbour_sets[i].insert(j);
-        heuristic.SetNeighbourSets(neighbour_sets);
-
-        heuristic.RunSearch(100, 10);
-
-        // Converting the result to BnBsolver format
-        const auto &heurClique = heuristic.GetClique();
-        Qmax.assign(heurClique.begin(), heurClique.end());
-        */
-
-        // initial setup
-        setDegrees(vertices);
-        sortByDegree(vertices);
-        initColors(vertices);
-
-        // Starting the BnB
-        BnBrecursion(vertices);
-
-        if (logFile) {
-            double t = double(clock() - startTime) / CLOCKS_PER_SEC;
-            (*logFile) << "FINISHED - Clique size: " << Qmax.size()
-                       << "; time: " << t << '\n';
-        }
-    }
-
-    const std::vector<int>& GetClique() const { return Qmax; }
-
-    bool Check() const {
-        for (size_t i = 0; i < Qmax.size(); ++i)
-            for (size_t j = i + 1; j < Qmax.size(); ++j)
-                if (!adjMatrix[Qmax[i]][Qmax[j]]) return false;
-        return true;
-    }
-
-    void ClearClique() {
-        Q.clear();
-        Qmax.clear();
-        pk = 0;
-        level = 1;
-        for (auto &s : S) { s.i1 = 0; s.i2 = 0; }
-        for (auto &cls : C) cls.clear();
-    }
-
-    void SetLogger(std::ofstream& out, const std::string& name)
-    {
-        logFile = &out;
-        graphName = name;
-    }
-
-private:
-
-    std::ofstream* logFile = nullptr; 
-    clock_t startTime;                  
-    std::string graphName;              
-
-    // Vertex structure for convenience
-    struct Vertex {
-        int id;
-        int degree;
-    };
-
-    // for dynamic coloring if needed
-    struct StepCount {
-        int i1 = 0;
-        int i2 = 0;
-        void inc() { ++i1; }
-    };
-
-    std::vector<std::vector<bool>> adjMatrix;
-    std::vector<Vertex> vertices;
-    std::vector<int> Q, Qmax;
-    std::vector<std::vector<Vertex>> C;
-    std::vector<StepCount> S;
-    int level = 0;
-    int pk = 0;
-    const float Tlimit = 0.025f;
-
-    void ClearAll() {
-        Q.clear();
-        Qmax.clear();
-        C.clear();
-        S.clear();
-        level = 1;
-        pk = 0;
-    }
-
-    bool connection(int i, int j) const {
-        return adjMatrix[i][j];
-    }
-
-    // counting the degrees of vertices
-    void setDegrees(std::vector<Vertex>& R) {
-        for (auto &v : R) {
-            int d = 0;
-            for (auto &u : R)
-                if (connection(v.id, u.id)) ++d;
-            v.degree = d;
-        }
-    }
-
-    // sorting by degrees in descending order
-    void sortByDegree(std::vector<Vertex>& R) {
-        std::sort(R.begin(), R.end(), [](const Vertex &a, const Vertex &b) {
-            return a.degree > b.degree;
-        });
-    }
-
-    // Starting initial upper bound by coloring
-    void initColors(std::vector<Vertex>& R) {
-        int max_degree = 0;
-        for (auto &v : R) if (v.degree > max_degree) max_degree = v.degree;
-        for (size_t i = 0; i < R.size(); ++i) {
-            if (i < (size_t)max_degree) R[i].degree = i + 1;
-            else R[i].degree = max_degree + 1;
-        }
-    }
-
-    // Checking if vertex v can be added to color class cls
-    bool cut1(const Vertex &v, const std::vector<Vertex> &cls) const {
-        for (auto &u : cls)
-            if (connection(v.id, u.id)) return true;
-        return false;
-    }
-
-    //Filtering vertices connected to the clique
-    void cut2(const std::vector<Vertex> &A, std::vector<Vertex> &B) const {
-        B.clear();
-        const Vertex &last = A.back();
-        for (size_t i = 0; i < A.size() - 1; ++i)
-            if (connection(last.id, A[i].id)) B.push_back(A[i]);
-    }
-
-    // Greedy coloring + sorting for branch upper bound
-    void color_sort(std::vector<Vertex> &R) {
-        int j = 0;
-        int maxno = 1;
-        int min_k = Qmax.size() - Q.size() + 1;
-        for (auto &cls : C) cls.clear();
-
-        for (auto &v : R) {
-            int k = 1;
-            while (cut1(v, C[k])) k++;
-            if (k > maxno) {
-                maxno = k;
-                if ((size_t)maxno + 1 >= C.size()) C.resize(maxno + 2);
-            }
-            C[k].push_back(v);
-            if (k < min_k) R[j++] = v;
-        }
-
-        if (j > 0) R[j-1].degree = 0;
-        if (min_k <= 0) min_k = 1;
-
-        for (int k = min_k; k <= maxno; ++k)
-            for (auto &v : C[k]) {
-                R[j] = v;
-                R[j++].degree = k;
-            }
-    }
-
-    // The main BnB recursion function
-    void BnBrecursion(std::vector<Vertex> R)
-    {
-        // Updating the depth statistic
-        S[level].i1 += S[level-1].i1 - S[level].i2;
-        S[level].i2 = S[level-1].i1;
-
-        while (!R.empty()) {
-            Vertex v = R.back();
-
-            // UB check
-            if ((int)Q.size() + v.degree > (int)Qmax.size()) {
-                Q.push_back(v.id);
-
-                std::vector<Vertex> Rp;
-                cut2(R, Rp);
-
-                if (!Rp.empty()) {
-
-                    // Dynamic coloring condition
-                    if ((float)S[level].i1 / ++pk < Tlimit) {
-                        setDegrees(Rp);
-                        sortByDegree(Rp);
-                    }
-                    color_sort(Rp);
-                    S[level].inc();
-                    level++;
-                    BnBrecursion(Rp);
-                    level--;
-
-                // Found a leaf, check if better than best known
-                } else if (Q.size() > Qmax.size()) {
-                    Qmax = Q;
-
-                    if (logFile) {
-                        double t = double(clock() - startTime) / CLOCKS_PER_SEC;
-                        (*logFile) << "New best: " << Qmax.size()
-                                << "; time: " << t << '\n';
-                    }
-                }
-                Q.pop_back();
-                R.pop_back();
-
-            // if not, nothing to search, go back
-            } else {
-                return;
-            }
-        }
-    }
-};
-
-int main()
+int main(int argc, char* argv[])
 {
+    // Optional arguments: search engine (mcqd by default, or bbmc)
+    BnBSolver::Engine engine = BnBSolver::Engine::MCQD;
+    if (argc > 1 && std::string(argv[1]) == "bbmc") engine = BnBSolver::Engine::BBMC;
+    // Second optional argument: number of threads for the MCQD search,
+    // third: number of tabu search threads feeding the incumbent,
+    // fourth: MCQD bound (coloring by default, or maxsat), fifth: time limit per graph in seconds,
+    // sixth: JSON file for the search statistics (also times color_sort, cut2 and the re-sort),
+    // seventh: Tlimit of the MCQD dynamic re-sort
+    int threads = argc > 2 ? std::max(1, atoi(argv[2])) : 1;
+    int portfolio = argc > 3 ? std::max(0, atoi(argv[3])) : 0;
+    BnBSolver::Bound bound = BnBSolver::Bound::Coloring;
+    if (argc > 4 && std::string(argv[4]) == "maxsat") bound = BnBSolver::Bound::MaxSat;
+    double timeLimit = argc > 5 ? atof(argv[5]) : std::numeric_limits<double>::infinity();
+    std::string statsFile = argc > 6 ? argv[6] : "";
+    float tlimit = argc > 7 ? (float)atof(argv[7]) : 0.025f;
+
     //ios_base::sync_with_stdio(false);
     //cin.tie(nullptr);
     vector<string> files = 
@@ -325,13 +51,25 @@ int main()
     //ofstream fout("clique_bnb.csv");
     //fout << "File; Clique; Time (sec)\n";
     ofstream log("output.txt");
+    ofstream stats;
+    int statsWritten = 0;
+    if (!statsFile.empty()) {
+        stats.open(statsFile);
+        stats << "[\n";
+    }
     for (string file : files)
     {
         BnBSolver problem;
         problem.ReadGraphFile(file);
-        problem.ClearClique();
-        clock_t start = clock();
+        problem.ClearAll();
         problem.SetLogger(log, file);
+        problem.SetEngine(engine);
+        problem.SetThreads(threads);
+        problem.SetPortfolio(portfolio);
+        problem.SetBound(bound);
+        problem.SetTimeLimit(timeLimit);
+        problem.SetTlimit(tlimit);
+        problem.SetStatsTiming(stats.is_open());
         problem.RunBnB();
         if (! problem.Check())
         {
@@ -339,7 +77,24 @@ int main()
             //fout << "*** WARNING: incorrect clique ***\n";
         }
         //fout << file << "; " << problem.GetClique().size() << "; " << double(clock() - start) / 1000 << '\n';
-        cout << file << ", result - " << problem.GetClique().size() << ", time - " << double(clock() - start) / 1000 << '\n';
+        cout << file << ", result - " << problem.GetClique().size()
+             << (problem.WasInterrupted() ? " (time limit, not proven)" : "")
+             << ", time - " << problem.GetElapsedSeconds()
+             << ", nodes - " << problem.GetNodes()
+             << ", allocations during search - " << problem.GetSearchAllocations() << '\n';
+        perf_counters::Report(cout, file);
+        if (stats.is_open()) {
+            stats << (statsWritten++ ? ",\n  " : "  ")
+                  << "{\"graph\": \"" << file << "\", \"engine\": \"" << (problem.GetEngineUsed() == BnBSolver::Engine::BBMC ? "bbmc" : "mcqd")
+                  << "\", \"bound\": \"" << (bound == BnBSolver::Bound::MaxSat ? "maxsat" : "coloring")
+                  << "\", \"threads\": " << threads << ", \"tlimit\": " << tlimit
+                  << ", \"clique\": " << problem.GetClique().size()
+                  << ", \"interrupted\": " << (problem.WasInterrupted() ? "true" : "false")
+                  << ", \"seconds\": " << problem.GetElapsedSeconds() << ", \"stats\": ";
+            problem.GetStats().WriteJson(stats);
+            stats << "}";
+        }
     }
+    if (stats.is_open()) stats << "\n]\n";
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+
+// Search-tree statistics of one branch and bound run (MCQD or BBMC).
+// Every worker fills its own copy, the solver merges them when the search ends.
+// The counters are plain increments and always on; the per-operation times need two
+// clock reads per call and are only taken when `timing` is set.
+// Depths count from 1 (the root) in both engines.
+struct SearchStats {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<long long> nodesPerDepth;   // index = depth
+    long long boundPrunes = 0;              // nodes whose remaining branches were cut by the bound
+    long long prunedBranches = 0;           // branches skipped by those cuts
+    long long children = 0;                 // candidate sets Rp built (cut2)
+    long long childCandidates = 0;          // their total size
+    long long leaves = 0;                   // children with an empty Rp
+    long long resortChecks = 0;             // MCQD dynamic re-sort decisions (Tlimit test)
+    long long resorts = 0;                  // ... and how many of them re-sorted by degree
+    long long maxSatAbsorbed = 0;           // vertices moved out of branching by MaxSAT reasoning
+    bool timing = false;
+    double colorSortSeconds = 0;            // color_sort (BBMC: ColorSort)
+    double cut2Seconds = 0;                 // cut2 (BBMC: the AND of P with a row)
+    double resortSeconds = 0;               // setDegrees + sortByDegree of the dynamic re-sort
+
+    void Reset(int maxDepth, bool withTiming) {
+        *this = SearchStats();
+        nodesPerDepth.assign(maxDepth + 1, 0);
+        timing = withTiming;
+    }
+
+    // Start of a timed operation (a zero time point when timing is off)
+    Clock::time_point Start() const {
+        return timing ? Clock::now() : Clock::time_point();
+    }
+
+    void Stop(double& seconds, Clock::time_point start) const {
+        if (timing) seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    long long Nodes() const {
+        long long total = 0;
+        for (long long n : nodesPerDepth) total += n;
+        return total;
+    }
+
+    void Merge(const SearchStats& other) {
+        if (nodesPerDepth.size() < other.nodesPerDepth.size()) nodesPerDepth.resize(other.nodesPerDepth.size(), 0);
+        for (size_t d = 0; d < other.nodesPerDepth.size(); ++d) nodesPerDepth[d] += other.nodesPerDepth[d];
+        boundPrunes += other.boundPrunes;
+        prunedBranches += other.prunedBranches;
+        children += other.children;
+        childCandidates += other.childCandidates;
+        leaves += other.leaves;
+        resortChecks += other.resortChecks;
+        resorts += other.resorts;
+        maxSatAbsorbed += other.maxSatAbsorbed;
+        timing = timing || other.timing;
+        colorSortSeconds += other.colorSortSeconds;
+        cut2Seconds += other.cut2Seconds;
+        resortSeconds += other.resortSeconds;
+    }
+
+    // One JSON object; the times are null unless they were taken
+    void WriteJson(std::ostream& out) const {
+        size_t depths = nodesPerDepth.size();
+        while (depths > 1 && nodesPerDepth[depths - 1] == 0) --depths;
+        out << "{\"nodes\": " << Nodes() << ", \"nodes_per_depth\": [";
+        // depth 0 is unused
+        for (size_t d = 1; d < depths; ++d) out << (d > 1 ? ", " : "") << nodesPerDepth[d];
+        out << "], \"bound_prunes\": " << boundPrunes
+            << ", \"pruned_branches\": " << prunedBranches
+            << ", \"children\": " << children
+            << ", \"average_rp_size\": " << (children ? (double)childCandidates / children : 0.0)
+            << ", \"leaves\": " << leaves
+            << ", \"resort_checks\": " << resortChecks
+            << ", \"resorts\": " << resorts
+            << ", \"maxsat_absorbed\": " << maxSatAbsorbed
+            << ", \"seconds\": ";
+        if (timing) {
+            out << "{\"color_sort\": " << colorSortSeconds << ", \"cut2\": " << cut2Seconds
+                << ", \"resort\": " << resortSeconds << "}";
+        } else {
+            out << "null";
+        }
+        out << "}";
+    }
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Minimal work-stealing pool: every worker owns a deque, pushes and pops at its back
+// (depth-first, cache friendly) and steals from the front of the others (the oldest,
+// usually largest subproblems). Run() returns when all deques are empty and no task is running.
+template <class Task>
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads) : queues(threads) {}
+
+    int Threads() const { return (int)queues.size(); }
+
+    void Push(int worker, Task task) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(queues[worker].mutex);
+        queues[worker].tasks.push_back(std::move(task));
+    }
+
+    // True while some worker is waiting for work: running tasks should split
+    bool HasIdle() const {
+        return idle.load(std::memory_order_relaxed) > 0;
+    }
+
+    // Executes body(worker, task) on Threads() threads until no work is left
+    void Run(const std::function<void(int, Task&)>& body) {
+        std::vector<std::thread> threads;
+        for (int w = 1; w < Threads(); ++w)
+            threads.emplace_back([this, w, &body] { WorkerLoop(w, body); });
+        WorkerLoop(0, body);
+        for (auto& t : threads) t.join();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<Queue> queues;
+    std::atomic<long long> pending{0};
+    std::atomic<int> idle{0};
+
+    bool Pop(int worker, Task& task) {
+        {
+            Queue& own = queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (int k = 1; k < Threads(); ++k) {
+            Queue& victim = queues[(worker + k) % Threads()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(int worker, const std::function<void(int, Task&)>& body) {
+        Task task;
+        bool waiting = false;
+        while (true) {
+            if (Pop(worker, task)) {
+                if (waiting) {
+                    idle.fetch_sub(1, std::memory_order_relaxed);
+                    waiting = false;
+                }
+                body(worker, task);
+                pending.fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+            if (pending.load(std::memory_order_acquire) == 0) break;
+            if (!waiting) {
+                idle.fetch_add(1, std::memory_order_relaxed);
+                waiting = true;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        if (waiting) idle.fetch_sub(1, std::memory_order_relaxed);
+    }
+};